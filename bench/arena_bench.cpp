@@ -0,0 +1,78 @@
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include <ka/common/arena.hpp>
+#include <ka/common/fixed.hpp>
+
+namespace
+{
+
+constexpr std::size_t allocations = 1024;
+
+//! Sizes of a typical mix of small records, the first argument scales them.
+[[nodiscard]] std::size_t allocation_size(const benchmark::State & state, const std::size_t i) noexcept
+{
+    return static_cast<std::size_t>(state.range(0)) * (1 + i % 4);
+}
+
+void bench_new_delete(benchmark::State & state)
+{
+    std::array<std::unique_ptr<std::byte[]>, allocations> blocks;
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            blocks[i].reset(new std::byte[allocation_size(state, i)]);
+            benchmark::DoNotOptimize(blocks[i].get());
+        }
+        for (auto & block : blocks)
+        {
+            block.reset();
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * allocations));
+}
+
+//! Allocations bump a pointer, rewinding frees them all at once.
+void bench_arena(benchmark::State & state)
+{
+    ka::Arena arena;
+    for (auto _ : state)
+    {
+        const auto mark = arena.mark();
+        for (std::size_t i = 0; i < allocations; ++i)
+        {
+            benchmark::DoNotOptimize(arena.allocate(allocation_size(state, i)));
+        }
+        arena.rewind(mark);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * allocations));
+}
+
+void bench_thread_pool(benchmark::State & state)
+{
+    auto & pool = ka::thread_pool();
+    std::array<void *, allocations> blocks {};
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            blocks[i] = pool.allocate(allocation_size(state, i));
+            benchmark::DoNotOptimize(blocks[i]);
+        }
+        for (auto * const block : blocks)
+        {
+            ka::PoolResource::deallocate(block);
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * allocations));
+}
+
+BENCHMARK(bench_new_delete)->ArgName("size")->Arg(16)->Arg(64)->Arg(256)->Threads(1)->Threads(4);
+BENCHMARK(bench_arena)->ArgName("size")->Arg(16)->Arg(64)->Arg(256)->Threads(1)->Threads(4);
+BENCHMARK(bench_thread_pool)->ArgName("size")->Arg(16)->Arg(64)->Arg(256)->Threads(1)->Threads(4);
+
+} // namespace
@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <ka/common/assert.hpp>
+#include <ka/common/fixed.hpp>
+
+namespace
+{
+
+//! Indexed reads, each checked by AR_ASSERT_FAST or not at all.
+template <bool Checked>
+void bench_indexed_sum(benchmark::State & state)
+{
+    const auto size = static_cast<std::size_t>(state.range(0));
+    std::vector<ka::u32> values(size);
+    std::iota(values.begin(), values.end(), 0);
+    std::vector<std::size_t> indices(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        indices[i] = i * 7919 % size;
+    }
+    for (auto _ : state)
+    {
+        ka::u64 sum = 0;
+        for (const auto index : indices)
+        {
+            if constexpr (Checked)
+            {
+                AR_ASSERT_FAST(index < values.size());
+            }
+            sum += values[index];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(bench_indexed_sum, false)->Arg(4096);
+BENCHMARK_TEMPLATE(bench_indexed_sum, true)->Arg(4096);
+
+//! With the assumption the compiler drops the scalar remainder of the vectorized loop.
+template <bool Assume>
+void scale(ka::f32 * const data, const std::size_t size, const ka::f32 factor) noexcept
+{
+    if constexpr (Assume)
+    {
+        AR_ASSUME(size % 8 == 0);
+    }
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        data[i] *= factor;
+    }
+}
+
+template <bool Assume>
+void bench_scale(benchmark::State & state)
+{
+    auto size = static_cast<std::size_t>(state.range(0));
+    std::vector<ka::f32> data(size, 1.0f);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(size);
+        scale<Assume>(data.data(), size, 1.0f);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(bench_scale, false)->DenseRange(24, 80, 8);
+BENCHMARK_TEMPLATE(bench_scale, true)->DenseRange(24, 80, 8);
+
+} // namespace
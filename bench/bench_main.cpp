@@ -0,0 +1,25 @@
+//! Runs the benchmarks of ka_common and writes the results as JSON, so that releases can be compared, e.g. with
+//! tools/compare.py of Google Benchmark. Usage: ka_common_bench [benchmark flags], --benchmark_format overrides JSON.
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+int main(int argc, char ** argv)
+{
+    static char json_format[] = "--benchmark_format=json";
+    std::vector<char *> args(argv, argv + argc);
+    // Flags given later win, so the format of the command line replaces this one.
+    args.insert(args.begin() + 1, json_format);
+    auto count = static_cast<int>(args.size());
+    args.push_back(nullptr);
+
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
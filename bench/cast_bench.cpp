@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <ka/common/cast.hpp>
+#include <ka/common/checked.hpp>
+#include <ka/common/fixed.hpp>
+
+namespace
+{
+
+constexpr std::size_t cast_size = 4096;
+
+//! Values which every benchmarked conversion converts exactly.
+template <typename S>
+[[nodiscard]] std::vector<S> exact_values(const std::size_t size)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<ka::s32> distribution(-1'000'000, 1'000'000);
+    std::vector<S> values(size);
+    for (auto & value : values)
+    {
+        value = static_cast<S>(distribution(random));
+    }
+    return values;
+}
+
+//! The scalar exact_cast of the pair of types, floats and integers have functions of their own.
+template <typename T, typename S>
+[[nodiscard]] T scalar_exact_cast(const S value) noexcept
+{
+    if constexpr (std::integral<T> && ka::ieee_float<S>)
+    {
+        return ka::exact_cast_float<T>(value);
+    }
+    else if constexpr (ka::ieee_float<T> && std::integral<S>)
+    {
+        return ka::exact_cast_int<T>(value);
+    }
+    else
+    {
+        return ka::exact_cast<T>(value);
+    }
+}
+
+//! One exact_cast per element, checked by AR_NESTED_ASSERT at assertion level 2 and unchecked below.
+template <typename T, typename S>
+void bench_exact_cast_scalar(benchmark::State & state)
+{
+    const auto source = exact_values<S>(cast_size);
+    std::vector<T> target(source.size());
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < source.size(); ++i)
+        {
+            target[i] = scalar_exact_cast<T>(source[i]);
+        }
+        benchmark::DoNotOptimize(target.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+template <typename T, typename S>
+void bench_try_exact_cast_scalar(benchmark::State & state)
+{
+    const auto source = exact_values<S>(cast_size);
+    std::vector<T> target(source.size());
+    for (auto _ : state)
+    {
+        std::size_t failures = 0;
+        for (std::size_t i = 0; i < source.size(); ++i)
+        {
+            const auto result = ka::try_exact_cast<T>(source[i]);
+            failures += !result;
+            target[i] = result.value_or(T {});
+        }
+        benchmark::DoNotOptimize(failures);
+        benchmark::DoNotOptimize(target.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+//! The span form checks every element in all builds.
+template <typename T, typename S>
+void bench_exact_cast_span(benchmark::State & state)
+{
+    const auto source = exact_values<S>(cast_size);
+    std::vector<T> target(source.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ka::exact_cast(source, target));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+template <typename T, typename S>
+void bench_saturate_cast_span(benchmark::State & state)
+{
+    const auto source = exact_values<S>(cast_size);
+    std::vector<T> target(source.size());
+    for (auto _ : state)
+    {
+        ka::saturate_cast(source, target);
+        benchmark::DoNotOptimize(target.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+//! Aligned and padded source and target, converted without a scalar epilogue.
+template <typename T, typename S>
+void bench_exact_cast_aligned(benchmark::State & state)
+{
+    const auto values = exact_values<S>(cast_size);
+    ka::AlignedBuffer<S> source(values.size());
+    std::copy(values.begin(), values.end(), source.begin());
+    ka::AlignedBuffer<T> target(source.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ka::exact_cast(source, target));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+template <typename T, typename S>
+void bench_saturate_cast_aligned(benchmark::State & state)
+{
+    const auto values = exact_values<S>(cast_size);
+    ka::AlignedBuffer<S> source(values.size());
+    std::copy(values.begin(), values.end(), source.begin());
+    ka::AlignedBuffer<T> target(source.size());
+    for (auto _ : state)
+    {
+        ka::saturate_cast(source, target);
+        benchmark::DoNotOptimize(target.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+BENCHMARK_TEMPLATE(bench_exact_cast_scalar, ka::s32, ka::f64);
+BENCHMARK_TEMPLATE(bench_try_exact_cast_scalar, ka::s32, ka::f64);
+BENCHMARK_TEMPLATE(bench_exact_cast_span, ka::s32, ka::f64);
+BENCHMARK_TEMPLATE(bench_saturate_cast_span, ka::s32, ka::f64);
+BENCHMARK_TEMPLATE(bench_exact_cast_aligned, ka::s32, ka::f64);
+BENCHMARK_TEMPLATE(bench_saturate_cast_aligned, ka::s32, ka::f64);
+
+BENCHMARK_TEMPLATE(bench_exact_cast_scalar, ka::f32, ka::s32);
+BENCHMARK_TEMPLATE(bench_try_exact_cast_scalar, ka::f32, ka::s32);
+BENCHMARK_TEMPLATE(bench_exact_cast_span, ka::f32, ka::s32);
+
+BENCHMARK_TEMPLATE(bench_exact_cast_scalar, ka::s32, ka::s64);
+BENCHMARK_TEMPLATE(bench_try_exact_cast_scalar, ka::s32, ka::s64);
+BENCHMARK_TEMPLATE(bench_exact_cast_span, ka::s32, ka::s64);
+BENCHMARK_TEMPLATE(bench_saturate_cast_span, ka::s32, ka::s64);
+BENCHMARK_TEMPLATE(bench_exact_cast_aligned, ka::s32, ka::s64);
+BENCHMARK_TEMPLATE(bench_saturate_cast_aligned, ka::s32, ka::s64);
+
+void bench_sum_plain(benchmark::State & state)
+{
+    const auto values = exact_values<ka::s32>(cast_size);
+    for (auto _ : state)
+    {
+        ka::s64 sum = 0;
+        for (const auto value : values)
+        {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * values.size()));
+}
+
+void bench_sum_checked(benchmark::State & state)
+{
+    const auto values = exact_values<ka::s32>(cast_size);
+    for (auto _ : state)
+    {
+        ka::s64 sum = 0;
+        for (const auto value : values)
+        {
+            sum = ka::checked_add(sum, value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * values.size()));
+}
+
+void bench_sum_saturating(benchmark::State & state)
+{
+    const auto values = exact_values<ka::s32>(cast_size);
+    for (auto _ : state)
+    {
+        ka::s64 sum = 0;
+        for (const auto value : values)
+        {
+            sum = ka::saturating_add(sum, value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * values.size()));
+}
+
+BENCHMARK(bench_sum_plain);
+BENCHMARK(bench_sum_checked);
+BENCHMARK(bench_sum_saturating);
+
+} // namespace
@@ -0,0 +1,133 @@
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <ka/common/cast.hpp>
+#include <ka/common/charconv.hpp>
+#include <ka/common/fixed.hpp>
+
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable : 4996)
+    #include <fmt/format.h>
+    #pragma warning(pop)
+#else
+    #include <fmt/format.h>
+#endif
+
+namespace
+{
+
+constexpr std::size_t number_count = 4096;
+
+//! Magnitudes spread over all digit counts, like line numbers, thread ids and payload values mixed together.
+template <typename T>
+[[nodiscard]] std::vector<T> random_numbers()
+{
+    std::mt19937_64 random(1);
+    std::vector<T> numbers(number_count);
+    for (auto & number : numbers)
+    {
+        if constexpr (std::integral<T>)
+        {
+            number = static_cast<T>(random() >> (random() % 64));
+        }
+        else
+        {
+            number = static_cast<T>(std::uniform_real_distribution<T>(-1e6, 1e6)(random));
+        }
+    }
+    return numbers;
+}
+
+template <typename T>
+void bench_write_number(benchmark::State & state)
+{
+    const auto numbers = random_numbers<T>();
+    std::array<char, ka::max_number_chars<T>> chars;
+    for (auto _ : state)
+    {
+        for (const auto number : numbers)
+        {
+            benchmark::DoNotOptimize(ka::write_number(chars.data(), number));
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * numbers.size()));
+}
+
+//! What the log prefix did before: a format string per number.
+template <typename T>
+void bench_fmt_format_to(benchmark::State & state)
+{
+    const auto numbers = random_numbers<T>();
+    std::array<char, ka::max_number_chars<T>> chars;
+    for (auto _ : state)
+    {
+        for (const auto number : numbers)
+        {
+            benchmark::DoNotOptimize(fmt::format_to(chars.data(), "{}", number));
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * numbers.size()));
+}
+
+BENCHMARK_TEMPLATE(bench_write_number, ka::u32);
+BENCHMARK_TEMPLATE(bench_fmt_format_to, ka::u32);
+BENCHMARK_TEMPLATE(bench_write_number, ka::s64);
+BENCHMARK_TEMPLATE(bench_fmt_format_to, ka::s64);
+BENCHMARK_TEMPLATE(bench_write_number, ka::f64);
+BENCHMARK_TEMPLATE(bench_fmt_format_to, ka::f64);
+
+[[nodiscard]] std::vector<std::string> random_texts()
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<ka::s32> distribution(-1'000'000, 1'000'000);
+    std::vector<std::string> texts(number_count);
+    for (auto & text : texts)
+    {
+        text = std::to_string(distribution(random));
+    }
+    return texts;
+}
+
+void bench_parse_exact(benchmark::State & state)
+{
+    const auto texts = random_texts();
+    for (auto _ : state)
+    {
+        for (const auto & text : texts)
+        {
+            benchmark::DoNotOptimize(ka::parse_exact<ka::s32>(text));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * texts.size()));
+}
+
+//! The two steps parse_exact replaces: parsing into a wide type and converting it.
+void bench_from_chars_then_cast(benchmark::State & state)
+{
+    const auto texts = random_texts();
+    for (auto _ : state)
+    {
+        for (const auto & text : texts)
+        {
+            ka::f64 value;
+            const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            benchmark::DoNotOptimize(
+                result.ec == std::errc {} ? ka::try_exact_cast<ka::s32>(value) : std::optional<ka::s32> {});
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * texts.size()));
+}
+
+BENCHMARK(bench_parse_exact);
+BENCHMARK(bench_from_chars_then_cast);
+
+} // namespace
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <ka/common/fixed.hpp>
+#include <ka/common/flat_hash.hpp>
+#include <ka/common/hash.hpp>
+#include <ka/common/intern.hpp>
+
+namespace
+{
+
+[[nodiscard]] std::vector<ka::u8> random_bytes(const std::size_t size)
+{
+    std::mt19937_64 random(size);
+    std::vector<ka::u8> bytes(size);
+    for (auto & byte : bytes)
+    {
+        byte = static_cast<ka::u8>(random());
+    }
+    return bytes;
+}
+
+[[nodiscard]] std::vector<ka::u64> random_keys(const std::size_t size, const ka::u64 seed = 1)
+{
+    std::mt19937_64 random(seed);
+    std::vector<ka::u64> keys(size);
+    for (auto & key : keys)
+    {
+        key = random();
+    }
+    return keys;
+}
+
+//! Keys longer than the small string buffer, so that building a std::string from one allocates.
+[[nodiscard]] std::vector<std::string> random_strings(const std::size_t size)
+{
+    std::vector<std::string> strings;
+    strings.reserve(size);
+    for (const auto key : random_keys(size))
+    {
+        strings.push_back("key/" + std::to_string(key) + "/value");
+    }
+    return strings;
+}
+
+template <typename H>
+void bench_hasher_update(benchmark::State & state)
+{
+    const auto data = random_bytes(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(data.data());
+        H hasher;
+        hasher.update(data.data(), data.size());
+        benchmark::DoNotOptimize(hasher.digest());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(bench_hasher_update, ka::Fnv1aHasher)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(bench_hasher_update, ka::MixHasher)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(bench_hasher_update, ka::WyHasher)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(bench_hasher_update, ka::StripeHasher)->RangeMultiplier(4)->Range(4, 4096);
+
+template <typename H>
+void bench_hash_keys(benchmark::State & state)
+{
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    std::vector<ka::u64> digests(keys.size());
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            digests[i] = ka::Hash<H> {}(keys[i]);
+        }
+        benchmark::DoNotOptimize(digests.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+template <typename H>
+void bench_hash_batch(benchmark::State & state)
+{
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    std::vector<ka::u64> digests(keys.size());
+    for (auto _ : state)
+    {
+        ka::hash_batch<H>(keys, digests);
+        benchmark::DoNotOptimize(digests.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+//! Keys and digests in aligned buffers, an odd size runs the last group into the padding.
+template <typename H>
+void bench_hash_batch_aligned(benchmark::State & state)
+{
+    const auto values = random_keys(static_cast<std::size_t>(state.range(0)));
+    ka::CacheAlignedBuffer<ka::u64> keys(values.size());
+    std::copy(values.begin(), values.end(), keys.begin());
+    ka::CacheAlignedBuffer<ka::u64> digests(keys.size());
+    for (auto _ : state)
+    {
+        ka::hash_batch<H>(keys, digests);
+        benchmark::DoNotOptimize(digests.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(bench_hash_keys, ka::MixHasher)->Arg(4096);
+BENCHMARK_TEMPLATE(bench_hash_batch, ka::MixHasher)->Arg(4096)->Arg(4099);
+BENCHMARK_TEMPLATE(bench_hash_batch_aligned, ka::MixHasher)->Arg(4096)->Arg(4099);
+BENCHMARK_TEMPLATE(bench_hash_keys, ka::WyHasher)->Arg(4096);
+BENCHMARK_TEMPLATE(bench_hash_batch, ka::WyHasher)->Arg(4096)->Arg(4099);
+BENCHMARK_TEMPLATE(bench_hash_batch_aligned, ka::WyHasher)->Arg(4096)->Arg(4099);
+
+//! Looks up string_view keys without building a std::string, through StrHash and StrEq.
+void bench_str_lookup_transparent(benchmark::State & state)
+{
+    const auto strings = random_strings(static_cast<std::size_t>(state.range(0)));
+    std::unordered_map<std::string, int, ka::StrHash<>, ka::StrEq> map;
+    for (const auto & string : strings)
+    {
+        map.try_emplace(string, 0);
+    }
+    const std::vector<std::string_view> views(strings.begin(), strings.end());
+    for (auto _ : state)
+    {
+        for (const auto view : views)
+        {
+            benchmark::DoNotOptimize(map.find(view));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+//! The usual workaround without heterogeneous lookup: a temporary std::string per lookup.
+void bench_str_lookup_std_string(benchmark::State & state)
+{
+    const auto strings = random_strings(static_cast<std::size_t>(state.range(0)));
+    std::unordered_map<std::string, int> map;
+    for (const auto & string : strings)
+    {
+        map.try_emplace(string, 0);
+    }
+    const std::vector<std::string_view> views(strings.begin(), strings.end());
+    for (auto _ : state)
+    {
+        for (const auto view : views)
+        {
+            benchmark::DoNotOptimize(map.find(std::string(view)));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(bench_str_lookup_transparent)->Arg(1024);
+BENCHMARK(bench_str_lookup_std_string)->Arg(1024);
+
+using FlatMap = ka::FlatHashMap<ka::u64, ka::u64>;
+using StdMap = std::unordered_map<ka::u64, ka::u64, ka::Hash<ka::MixHasher>>;
+
+template <typename Map>
+void bench_map_insert(benchmark::State & state)
+{
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        Map map;
+        for (const auto key : keys)
+        {
+            map.try_emplace(key, key);
+        }
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+//! Looks up the inserted keys, or as many other keys if the argument is 0.
+template <typename Map>
+void bench_map_find(benchmark::State & state)
+{
+    const auto keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    Map map;
+    for (const auto key : keys)
+    {
+        map.try_emplace(key, key);
+    }
+    const auto lookups = state.range(1) != 0 ? keys : random_keys(keys.size(), 2);
+    for (auto _ : state)
+    {
+        ka::u64 found = 0;
+        for (const auto key : lookups)
+        {
+            found += map.find(key) != map.end();
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(bench_map_insert, FlatMap)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(bench_map_insert, StdMap)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(bench_map_find, FlatMap)
+    ->ArgNames({ "keys", "hit" })
+    ->ArgsProduct({ { 1 << 10, 1 << 20 }, { 1, 0 } });
+BENCHMARK_TEMPLATE(bench_map_find, StdMap)
+    ->ArgNames({ "keys", "hit" })
+    ->ArgsProduct({ { 1 << 10, 1 << 20 }, { 1, 0 } });
+
+//! Interns strings which are already in the pool, from one or more threads.
+void bench_intern_existing(benchmark::State & state)
+{
+    static const auto strings = random_strings(4096);
+    static ka::StringPool pool;
+    static const bool interned = []
+    {
+        for (const auto & string : strings)
+        {
+            (void)pool.intern(string);
+        }
+        return true;
+    }();
+    benchmark::DoNotOptimize(interned);
+    for (auto _ : state)
+    {
+        for (const auto & string : strings)
+        {
+            benchmark::DoNotOptimize(pool.intern(string));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * strings.size()));
+}
+
+BENCHMARK(bench_intern_existing)->Threads(1)->Threads(4);
+
+} // namespace
@@ -0,0 +1,46 @@
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include <ka/common/fixed.hpp>
+#include <ka/common/instrument.hpp>
+
+namespace
+{
+
+//! Includes the two tick reads, which dominate on many machines.
+void bench_scoped_timer(benchmark::State & state)
+{
+    ka::u64 value = 0;
+    for (auto _ : state)
+    {
+        KA_SCOPED_TIMER("bench_scoped_timer");
+        benchmark::DoNotOptimize(++value);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+void bench_counter(benchmark::State & state)
+{
+    for (auto _ : state)
+    {
+        KA_COUNTER("bench_counter");
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+void bench_read_ticks(benchmark::State & state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ka::read_ticks());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK(bench_scoped_timer)->Threads(1)->Threads(4);
+BENCHMARK(bench_counter)->Threads(1)->Threads(4);
+BENCHMARK(bench_read_ticks);
+
+} // namespace
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <ka/common/fixed.hpp>
+#include <ka/common/log.hpp>
+#include <ka/common/log_sink.hpp>
+
+namespace
+{
+
+//! Has no ArgCodec, records with it are formatted on the calling thread.
+struct Endpoint final
+{
+    ka::u32 address;
+    ka::u16 port;
+};
+
+} // namespace
+
+template <>
+struct fmt::formatter<Endpoint>
+{
+    constexpr auto parse(fmt::format_parse_context & context)
+    {
+        return context.begin();
+    }
+
+    auto format(const Endpoint & endpoint, fmt::format_context & context) const
+    {
+        return fmt::format_to(
+            context.out(),
+            "{}.{}.{}.{}:{}",
+            endpoint.address >> 24,
+            (endpoint.address >> 16) & 0xff,
+            (endpoint.address >> 8) & 0xff,
+            endpoint.address & 0xff,
+            endpoint.port);
+    }
+};
+
+namespace
+{
+
+#ifdef _WIN32
+constexpr auto null_device = "NUL";
+#else
+constexpr auto null_device = "/dev/null";
+#endif
+
+//! Benchmarks take the mode as their first argument: 0 is asynchronous, 1 is synchronous.
+void set_up_logging(const benchmark::State & state)
+{
+    ka::set_log_sinks({ std::make_shared<ka::FileLogSink>(null_device) });
+    ka::set_log_mode(state.range(0) == 0 ? ka::LogMode::asynchronous : ka::LogMode::synchronous);
+    ka::set_log_level(ka::LogLevel::info);
+}
+
+void tear_down_logging(const benchmark::State &)
+{
+    ka::log_flush();
+    ka::set_log_mode(ka::LogMode::asynchronous);
+}
+
+//! Cost of a call on the producer thread. Asynchronous calls block once the queue is full, so the sustained rate
+//! includes the consumer.
+void bench_log_info_throughput(benchmark::State & state)
+{
+    ka::u64 request = 0;
+    for (auto _ : state)
+    {
+        ka::log_info("Request {} from {} took {} ms", ++request, "10.0.0.1", 12.5);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK(bench_log_info_throughput)
+    ->ArgName("sync")
+    ->Arg(0)
+    ->Arg(1)
+    ->Threads(1)
+    ->Threads(4)
+    ->Setup(set_up_logging)
+    ->Teardown(tear_down_logging);
+
+//! Formats on the calling thread into a stack buffer, the second argument pads the message past its capacity.
+void bench_log_info_eager(benchmark::State & state)
+{
+    const std::string padding(static_cast<std::size_t>(state.range(1)), '.');
+    ka::u64 request = 0;
+    for (auto _ : state)
+    {
+        ka::log_info("Request {} from {} took {} ms{}", ++request, Endpoint { 0x0a000001, 443 }, 12.5, padding);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK(bench_log_info_eager)
+    ->ArgNames({ "sync", "padding" })
+    ->Args({ 0, 0 })
+    ->Args({ 0, 512 })
+    ->Args({ 1, 0 })
+    ->Setup(set_up_logging)
+    ->Teardown(tear_down_logging);
+
+//! Percentiles of single calls measured with steady_clock, which adds its own cost of a few tens of nanoseconds.
+void bench_log_info_latency(benchmark::State & state)
+{
+    constexpr std::size_t max_samples = 1 << 20;
+    std::vector<ka::f64> samples;
+    samples.reserve(max_samples);
+    ka::u64 request = 0;
+    for (auto _ : state)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        ka::log_info("Request {} from {} took {} ms", ++request, "10.0.0.1", 12.5);
+        const auto end = std::chrono::steady_clock::now();
+        if (samples.size() < max_samples)
+        {
+            samples.push_back(std::chrono::duration<ka::f64, std::nano>(end - start).count());
+        }
+    }
+    if (samples.empty())
+    {
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&](const ka::f64 fraction)
+    {
+        const auto index = static_cast<std::size_t>(fraction * static_cast<ka::f64>(samples.size() - 1));
+        return benchmark::Counter(samples[index], benchmark::Counter::kAvgThreads);
+    };
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p999_ns"] = percentile(0.999);
+    state.counters["max_ns"] = percentile(1);
+}
+
+BENCHMARK(bench_log_info_latency)
+    ->ArgName("sync")
+    ->Arg(0)
+    ->Arg(1)
+    ->Threads(1)
+    ->Threads(4)
+    ->Setup(set_up_logging)
+    ->Teardown(tear_down_logging);
+
+//! A record below the runtime level, which only the flight recorder keeps if the second argument is 1.
+void bench_log_debug_filtered(benchmark::State & state)
+{
+    ka::u64 request = 0;
+    for (auto _ : state)
+    {
+        ka::log_debug("Request {} from {} took {} ms", ++request, "10.0.0.1", 12.5);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+void set_up_flight_recorder(const benchmark::State & state)
+{
+    set_up_logging(state);
+    if (state.range(1) != 0)
+    {
+        ka::enable_flight_recorder({ .install_signal_handlers = false });
+    }
+}
+
+void tear_down_flight_recorder(const benchmark::State & state)
+{
+    tear_down_logging(state);
+    // The recorder can't be disabled, keeping only fatal records comes closest.
+    ka::enable_flight_recorder({ .level = ka::LogLevel::fatal, .install_signal_handlers = false });
+}
+
+BENCHMARK(bench_log_debug_filtered)
+    ->ArgNames({ "sync", "recorder" })
+    ->Args({ 0, 0 })
+    ->Args({ 0, 1 })
+    ->Setup(set_up_flight_recorder)
+    ->Teardown(tear_down_flight_recorder);
+
+} // namespace
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+
+#include <ka/common/fixed.hpp>
+
+namespace ka
+{
+
+//! Monotonic allocator: memory is handed out from blocks by bumping a pointer, deallocation does nothing and
+//! everything is freed at once by rewind, reset or release. Not thread-safe.
+//! Also a std::pmr::memory_resource, e.g. for std::pmr::vector<int> values(&arena).
+class Arena final : public std::pmr::memory_resource
+{
+public:
+    constexpr static std::size_t default_block_size = 64 * 1024;
+
+    //! Position of the arena, see rewind.
+    struct Mark final
+    {
+        void * block;
+        std::byte * position;
+    };
+
+public:
+    explicit Arena(std::size_t block_size = default_block_size) noexcept;
+
+    //! Allocates from the buffer of the caller first, blocks are allocated once it is used up.
+    explicit Arena(std::span<std::byte> initial, std::size_t block_size = default_block_size) noexcept;
+
+    ~Arena() override;
+
+    Arena(const Arena &) = delete;
+    Arena & operator=(const Arena &) = delete;
+
+    //! The alignment must be a power of two. Throws std::bad_alloc if a new block can't be allocated, allocations
+    //! larger than a quarter of the block size get a block of their own.
+    [[nodiscard]] void * allocate(const std::size_t size, const std::size_t alignment = alignof(std::max_align_t))
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(position_);
+        const auto padding = (alignment - address % alignment) % alignment;
+        if (padding + size <= static_cast<std::size_t>(end_ - position_)) [[likely]]
+        {
+            auto * const result = position_ + padding;
+            position_ = result + size;
+            return result;
+        }
+        return allocate_slow(size, alignment);
+    }
+
+    [[nodiscard]] Mark mark() const noexcept
+    {
+        return { block_, position_ };
+    }
+
+    //! Frees everything allocated after the mark was taken, the blocks are kept for later allocations.
+    void rewind(Mark mark) noexcept;
+
+    //! Frees everything, the blocks are kept for later allocations.
+    void reset() noexcept;
+
+    //! Frees everything and returns the blocks to the heap.
+    void release() noexcept;
+
+private:
+    struct Block;
+
+    void * do_allocate(std::size_t size, std::size_t alignment) override;
+    void do_deallocate(void * data, std::size_t size, std::size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override;
+
+    [[nodiscard]] void * allocate_slow(std::size_t size, std::size_t alignment);
+    void enter(Block * block) noexcept;
+
+private:
+    std::size_t block_size_;
+    std::span<std::byte> initial_;
+    //! Blocks in use, the current one first.
+    Block * block_ = nullptr;
+    //! Blocks freed by rewind and reset.
+    Block * spare_ = nullptr;
+    std::byte * position_ = nullptr;
+    std::byte * end_ = nullptr;
+};
+
+//! Keeps freed blocks of up to max_pooled_size bytes in free lists by size class and carves new ones out of an
+//! Arena, larger blocks come from the heap. Blocks are allocated by one thread at a time but may be freed by any
+//! thread: blocks freed by other threads are handed back through a lock-free list per size class.
+class PoolResource final : public std::pmr::memory_resource
+{
+public:
+    constexpr static std::size_t min_pooled_size = 16;
+    constexpr static std::size_t max_pooled_size = 4096;
+    //! Alignment of every block, do_allocate serves larger alignments from the heap.
+    constexpr static std::size_t block_alignment = 16;
+
+public:
+    PoolResource() noexcept = default;
+    ~PoolResource() override = default;
+
+    PoolResource(const PoolResource &) = delete;
+    PoolResource & operator=(const PoolResource &) = delete;
+
+    //! Throws std::bad_alloc if the memory can't be allocated.
+    [[nodiscard]] void * allocate(std::size_t size);
+
+    //! Frees a block allocated by any pool, from any thread.
+    static void deallocate(void * data) noexcept;
+
+    //! Frees all blocks at once, also those not deallocated. Only blocks from the heap must be deallocated after it.
+    void release() noexcept;
+
+private:
+    struct Header;
+    struct FreeBlock;
+
+    constexpr static std::size_t size_classes = 9;
+    static_assert(min_pooled_size << (size_classes - 1) == max_pooled_size);
+
+    void * do_allocate(std::size_t size, std::size_t alignment) override;
+    void do_deallocate(void * data, std::size_t size, std::size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override;
+
+    //! Blocks from the heap are freed the same way as pooled ones.
+    [[nodiscard]] static void * allocate_heap(std::size_t size, std::size_t alignment);
+
+private:
+    Arena arena_;
+    std::array<FreeBlock *, size_classes> free_ {};
+    std::array<std::atomic<FreeBlock *>, size_classes> remote_free_ {};
+};
+
+//! Pool of the calling thread. Pools are never destroyed, the pool of a thread which exits is taken over by the
+//! next thread which asks for one, so blocks may outlive the thread which allocated them.
+[[nodiscard]] PoolResource & thread_pool();
+
+//! Deleter of std::unique_ptr for blocks of a PoolResource.
+struct PoolDeleter final
+{
+    void operator()(void * const data) const noexcept
+    {
+        PoolResource::deallocate(data);
+    }
+};
+
+} // namespace ka
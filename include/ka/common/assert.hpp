@@ -1,50 +1,134 @@
 #pragma once
 
+#include <source_location>
+#include <string_view>
+
 #include <ka/common/log.hpp>
 
 #if defined(__GNUC__) // GCC, Clang, ICC
     #define _KA_UNREACHABLE __builtin_unreachable()
+    #define _KA_COLD [[gnu::cold, gnu::noinline]]
 #elif defined(_MSC_VER) // MSVC
     #define _KA_UNREACHABLE __assume(false)
+    #define _KA_COLD __declspec(noinline)
 #endif
 
-#ifdef NDEBUG
-    #define AR_ASSERT(condition) ((void)0)
-    #define AR_PRE(condition) ((void)0)
-    #define AR_POST(condition) ((void)0)
-    #define AR_NESTED_ASSERT(condition, assert_type, location)                                                         \
-        ((void)(condition), (void)(assert_type), (void)(location))
-    #define AR_UNREACHABLE _KA_UNREACHABLE
-#else
-    #define AR_NESTED_ASSERT(condition, assert_type, location)                                                         \
+#if defined(__clang__)
+    #define _KA_ASSUME(condition) __builtin_assume(condition)
+#elif defined(__GNUC__) && __GNUC__ >= 13
+    #define _KA_ASSUME(condition) __attribute__((assume(condition)))
+#elif defined(__GNUC__)
+    // The condition is evaluated unless the compiler proves it has no side effects.
+    #define _KA_ASSUME(condition)                                                                                      \
         do                                                                                                             \
         {                                                                                                              \
             if (!(condition))                                                                                          \
             {                                                                                                          \
-                ::ka::__assert_detail::assert_handler(assert_type, #condition, location);                              \
+                __builtin_unreachable();                                                                               \
             }                                                                                                          \
         } while (false)
+#elif defined(_MSC_VER)
+    #define _KA_ASSUME(condition) __assume(condition)
+#endif
+
+// Assertion levels:
+// 0 - no checks;
+// 1 - AR_ASSERT_FAST, cheap checks which stay on in release builds;
+// 2 - also AR_ASSERT, AR_PRE, AR_POST, AR_UNREACHABLE and the checks of exact_cast;
+// 3 - also AR_AUDIT, expensive checks such as O(n) invariants.
+// The level is 1 with NDEBUG and 2 without it, unless the KA_ASSERT_LEVEL option of the ka_common target sets
+// KA_ASSERT_DEFAULT_LEVEL. A translation unit may define KA_ASSERT_LEVEL before including any ka header.
+//
+// AR_ASSUME is checked like AR_ASSERT at level 2 and tells the optimizer that the condition holds below it.
+// Defining KA_ASSERT_ASSUME, e.g. with the option of the same name, does the same for disabled AR_ASSERT, AR_PRE,
+// AR_POST and AR_NESTED_ASSERT. Their conditions must be free of side effects then, and an assumption which
+// doesn't hold is undefined behavior.
+#ifndef KA_ASSERT_LEVEL
+    #if defined(KA_ASSERT_DEFAULT_LEVEL)
+        #define KA_ASSERT_LEVEL KA_ASSERT_DEFAULT_LEVEL
+    #elif defined(NDEBUG)
+        #define KA_ASSERT_LEVEL 1
+    #else
+        #define KA_ASSERT_LEVEL 2
+    #endif
+#endif
+
+// The failure path is a lambda, so that the site descriptor can be static also in constexpr functions.
+#define _KA_FAIL(assert_type, condition_text, location)                                                                \
+    [](const std::source_location & _ka_location)                                                                      \
+    {                                                                                                                  \
+        constexpr static ::ka::__assert_detail::AssertSite _ka_site { assert_type, condition_text };                   \
+        ::ka::__assert_detail::assert_failed(_ka_site, _ka_location);                                                  \
+    }(location)
+
+#define _KA_CHECK(condition, assert_type, location)                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(condition)) [[unlikely]]                                                                                 \
+        {                                                                                                              \
+            _KA_FAIL(assert_type, #condition, location);                                                               \
+        }                                                                                                              \
+    } while (false)
+
+#if KA_ASSERT_LEVEL >= 1
+    #define AR_ASSERT_FAST(condition) _KA_CHECK(condition, "Assertion", std::source_location::current())
+#else
+    #define AR_ASSERT_FAST(condition) ((void)0)
+#endif
+
+#if KA_ASSERT_LEVEL >= 2
+    #define AR_NESTED_ASSERT(condition, assert_type, location) _KA_CHECK(condition, assert_type, location)
     #define AR_ASSERT(condition) AR_NESTED_ASSERT(condition, "Assertion", std::source_location::current())
     #define AR_PRE(condition) AR_NESTED_ASSERT(condition, "Precondition", std::source_location::current())
     #define AR_POST(condition) AR_NESTED_ASSERT(condition, "Postcondition", std::source_location::current())
     #define AR_UNREACHABLE                                                                                             \
         do                                                                                                             \
         {                                                                                                              \
-            ::ka::__assert_detail::assert_handler("Unreachable", "unreachable", std::source_location::current());      \
+            _KA_FAIL("Unreachable", "unreachable", std::source_location::current());                                  \
             _KA_UNREACHABLE;                                                                                           \
         } while (false)
+    #define AR_ASSUME(condition) AR_NESTED_ASSERT(condition, "Assumption", std::source_location::current())
+#elif defined(KA_ASSERT_ASSUME)
+    #define AR_ASSERT(condition) _KA_ASSUME(condition)
+    #define AR_PRE(condition) _KA_ASSUME(condition)
+    #define AR_POST(condition) _KA_ASSUME(condition)
+    #define AR_NESTED_ASSERT(condition, assert_type, location)                                                         \
+        do                                                                                                             \
+        {                                                                                                              \
+            (void)(assert_type);                                                                                       \
+            (void)(location);                                                                                          \
+            _KA_ASSUME(condition);                                                                                     \
+        } while (false)
+    #define AR_UNREACHABLE _KA_UNREACHABLE
+    #define AR_ASSUME(condition) _KA_ASSUME(condition)
+#else
+    #define AR_ASSERT(condition) ((void)0)
+    #define AR_PRE(condition) ((void)0)
+    #define AR_POST(condition) ((void)0)
+    #define AR_NESTED_ASSERT(condition, assert_type, location)                                                         \
+        ((void)(condition), (void)(assert_type), (void)(location))
+    #define AR_UNREACHABLE _KA_UNREACHABLE
+    #define AR_ASSUME(condition) _KA_ASSUME(condition)
+#endif
+
+#if KA_ASSERT_LEVEL >= 3
+    #define AR_AUDIT(condition) _KA_CHECK(condition, "Audit", std::source_location::current())
+#else
+    #define AR_AUDIT(condition) ((void)0)
 #endif
 
 namespace ka::__assert_detail
 {
 
-inline void assert_handler(
-    const std::string_view assert_type,
-    const std::string_view condition,
-    const std::source_location & location)
+//! Static part of an assertion, one per call site.
+struct AssertSite final
 {
-    log_assert(assert_type, condition, location);
-    std::abort();
-}
+    std::string_view assert_type;
+    std::string_view condition;
+};
+
+//! Logs the failure and aborts. Defined out of line and in cold code, so a check costs a predicted branch and the
+//! call site only passes two pointers.
+[[noreturn]] _KA_COLD void assert_failed(const AssertSite & site, const std::source_location & location);
 
 } // namespace ka::__assert_detail
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <cmath>
 #include <concepts>
+#include <cstddef>
 #include <numeric>
+#include <optional>
+#include <ranges>
 #include <source_location>
 #include <type_traits>
 #include <utility>
 
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
 #include <ka/common/assert.hpp>
 #include <ka/common/fixed.hpp>
 
@@ -34,17 +43,50 @@ template <std::signed_integral I, ieee_float F>
     return static_cast<F>(result);
 }
 
+namespace __cast_detail
+{
+
+//! The largest value of I which F represents exactly.
+template <std::integral I, ieee_float F>
+[[nodiscard]] consteval F max_exact_value() noexcept
+{
+    if constexpr (std::numeric_limits<I>::digits > std::numeric_limits<F>::digits)
+    {
+        return max_common_representable_number<I, F>();
+    }
+    else
+    {
+        return static_cast<F>(std::numeric_limits<I>::max());
+    }
+}
+
+//! The smallest value of I, F represents it exactly.
+template <std::integral I, ieee_float F>
+[[nodiscard]] consteval F min_exact_value() noexcept
+{
+    if constexpr (std::signed_integral<I>)
+    {
+        return min_common_representable_number<I, F>();
+    }
+    else
+    {
+        return F {};
+    }
+}
+
+} // namespace __cast_detail
+
 template <std::unsigned_integral Target, ieee_float Source>
 [[nodiscard]] constexpr bool in_exact_range(const Source value)
 {
-    return Target {} <= value && value <= max_common_representable_number<Target, Source>();
+    return Target {} <= value && value <= __cast_detail::max_exact_value<Target, Source>();
 }
 
 template <std::signed_integral Target, ieee_float Source>
 [[nodiscard]] constexpr bool in_exact_range(const Source value)
 {
-    return value >= min_common_representable_number<Target, Source>() &&
-           value <= max_common_representable_number<Target, Source>();
+    return value >= static_cast<Source>(std::numeric_limits<Target>::min()) &&
+           value <= __cast_detail::max_exact_value<Target, Source>();
 }
 
 template <std::integral Target, std::integral Source>
@@ -169,4 +211,279 @@ static_assert(!SafelyCastableTo<f64, s64>);
 static_assert(SafelyCastableTo<f64, f32>);
 static_assert(!SafelyCastableTo<f32, f64>);
 
+namespace __cast_detail
+{
+
+//! Returns value if condition holds and zero otherwise.
+template <ieee_float F>
+[[nodiscard]] constexpr F zero_unless(const bool condition, const F value) noexcept
+{
+#if defined(__SSE4_1__) || defined(__ARM_NEON)
+    // With trapping floating point math compilers keep a select of floats as a branch, which prevents
+    // vectorization. Selecting the bits is vectorized, but it is slower than a branch in scalar SSE2 code.
+    using Bits = std::conditional_t<sizeof(F) == sizeof(u64), u64, u32>;
+    return std::bit_cast<F>(std::bit_cast<Bits>(value) & (Bits {} - condition));
+#else
+    return condition ? value : F {};
+#endif
+}
+
+//! Converts value to target and returns whether the conversion is exact. Conditions are combined with & and
+//! values out of range are replaced before conversion, so loops over it have no branches and are vectorized.
+template <typename T, typename S>
+[[nodiscard]] constexpr bool convert_exact(const S value, T & target) noexcept
+{
+    if constexpr (std::integral<T> && std::integral<S>)
+    {
+        target = static_cast<T>(value);
+        return std::cmp_greater_equal(value, std::numeric_limits<T>::min()) &
+               std::cmp_less_equal(value, std::numeric_limits<T>::max());
+    }
+    else if constexpr (std::integral<T>)
+    {
+        const bool in_range = (value >= static_cast<S>(std::numeric_limits<T>::min())) &
+                              (value <= max_exact_value<T, S>());
+        target = static_cast<T>(zero_unless(in_range, value));
+        return in_range & (static_cast<S>(target) == value);
+    }
+    else if constexpr (std::integral<S>)
+    {
+        target = static_cast<T>(value);
+        if constexpr (std::numeric_limits<T>::digits >= std::numeric_limits<S>::digits)
+        {
+            return true;
+        }
+        else
+        {
+            // Values rounded up to 2^digits don't convert back to S.
+            constexpr auto limit = static_cast<T>(std::numeric_limits<S>::max() / 2 + 1) * 2;
+            const bool in_range = target < limit;
+            return in_range & (static_cast<S>(zero_unless(in_range, target)) == value);
+        }
+    }
+    else
+    {
+        const bool in_range = (value >= std::numeric_limits<T>::lowest()) & (value <= std::numeric_limits<T>::max());
+        target = static_cast<T>(zero_unless(in_range, value));
+        return in_range & (static_cast<S>(target) == value);
+    }
+}
+
+} // namespace __cast_detail
+
+//! Checked exact_cast for untrusted input: returns std::nullopt when the value is not converted exactly instead of
+//! asserting, both in debug and release builds. The checks are combined without branches, the only branch is the
+//! one on the result.
+template <typename T, typename S>
+    requires(std::integral<T> || ieee_float<T>) && (std::integral<S> || ieee_float<S>)
+[[nodiscard]] constexpr std::optional<T> try_exact_cast(const S value) noexcept
+{
+    T result;
+    if (__cast_detail::convert_exact(value, result))
+    {
+        return result;
+    }
+    return std::nullopt;
+}
+
+//! Converts the elements of source to the elements of target like exact_cast, but reports a failure instead of
+//! asserting. Returns the index of the first element which is not converted exactly, or source.size().
+//! Target elements from that index on are unspecified. The elements are checked in blocks with one test per
+//! block, so the loop is vectorized and converting valid data runs at memory speed. Between two AlignedBuffers the
+//! padding of target is overwritten.
+template <std::ranges::contiguous_range Source, std::ranges::contiguous_range Target>
+[[nodiscard]] constexpr size_t exact_cast(const Source & source, Target && target) noexcept
+    requires std::ranges::output_range<Target, std::ranges::range_value_t<Target>> &&
+             std::is_arithmetic_v<std::ranges::range_value_t<Source>> &&
+             std::is_arithmetic_v<std::ranges::range_value_t<Target>>
+{
+    constexpr size_t block_size = 256;
+
+    const auto size = static_cast<size_t>(std::ranges::size(source));
+    AR_PRE(static_cast<size_t>(std::ranges::size(target)) >= size);
+    const auto * const from = std::ranges::data(source);
+    auto * const to = std::ranges::data(target);
+    if constexpr (aligned_buffer<Source> && aligned_buffer<Target>)
+    {
+        // The loop runs over the padding too, which ends on a vector boundary of both buffers, so every vector is
+        // aligned and whole. Padding elements may fail, failures are only reported for elements of source.
+        const auto padded = std::min(source.padded_size(), target.padded_size());
+        for (size_t first = 0; first < padded; first += block_size)
+        {
+            const auto last = std::min(padded, first + block_size);
+            unsigned failures = 0;
+            for (size_t i = first; i < last; ++i)
+            {
+                failures += !__cast_detail::convert_exact(from[i], to[i]);
+            }
+            if (failures != 0)
+            {
+                for (size_t i = first;; ++i)
+                {
+                    if (std::ranges::range_value_t<Target> ignored; !__cast_detail::convert_exact(from[i], ignored))
+                    {
+                        return std::min(i, size);
+                    }
+                }
+            }
+        }
+        return size;
+    }
+    for (size_t first = 0; first < size; first += block_size)
+    {
+        const auto last = std::min(size, first + block_size);
+        // Failures are counted rather than or-ed as bool, compilers vectorize the sum.
+        unsigned failures = 0;
+        for (size_t i = first; i < last; ++i)
+        {
+            failures += !__cast_detail::convert_exact(from[i], to[i]);
+        }
+        if (failures != 0)
+        {
+            for (size_t i = first;; ++i)
+            {
+                if (std::ranges::range_value_t<Target> ignored; !__cast_detail::convert_exact(from[i], ignored))
+                {
+                    return i;
+                }
+            }
+        }
+    }
+    return size;
+}
+
+//! Converts the elements of source to the elements of target, target must be at least as long as source.
+template <std::ranges::contiguous_range Source, std::ranges::contiguous_range Target>
+constexpr void safe_cast(const Source & source, Target && target) noexcept
+    requires std::ranges::output_range<Target, std::ranges::range_value_t<Target>> &&
+             SafelyCastableTo<std::ranges::range_value_t<Target>, std::ranges::range_value_t<Source>>
+{
+    using T = std::ranges::range_value_t<Target>;
+
+    AR_PRE(std::ranges::size(target) >= std::ranges::size(source));
+    std::ranges::transform(source, std::ranges::begin(target), [](const auto value) { return safe_cast<T>(value); });
+}
+
+//! Converts an integer modulo 2^digits of T, the explicit form of the implicit conversion.
+template <std::integral T, std::integral S>
+[[nodiscard]] constexpr T wrap_cast(const S value) noexcept
+{
+    return static_cast<T>(value);
+}
+
+//! Converts an integer, clamping it to the range of T.
+template <std::integral T, std::integral S>
+[[nodiscard]] constexpr T saturate_cast(const S value) noexcept
+{
+    if (std::cmp_less(value, std::numeric_limits<T>::min()))
+    {
+        return std::numeric_limits<T>::min();
+    }
+    if (std::cmp_greater(value, std::numeric_limits<T>::max()))
+    {
+        return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(value);
+}
+
+namespace __cast_detail
+{
+
+//! Clamps value to [lowest, highest], NaN becomes 0.
+template <ieee_float F>
+[[nodiscard]] constexpr F clamp_or_zero(const F value, const F lowest, const F highest) noexcept
+{
+#if defined(__SSE2__) || defined(_M_X64)
+    // With trapping floating point math compilers keep min and max of floats as branches, maxsd and minsd don't
+    // branch. They return the second operand when the first one is NaN.
+    if (!std::is_constant_evaluated())
+    {
+        if constexpr (std::same_as<F, f64>)
+        {
+            const auto v = _mm_set_sd(value);
+            const auto clamped = _mm_min_sd(_mm_max_sd(v, _mm_set_sd(lowest)), _mm_set_sd(highest));
+            return _mm_cvtsd_f64(_mm_and_pd(clamped, _mm_cmpord_sd(v, v)));
+        }
+        else if constexpr (std::same_as<F, f32>)
+        {
+            const auto v = _mm_set_ss(value);
+            const auto clamped = _mm_min_ss(_mm_max_ss(v, _mm_set_ss(lowest)), _mm_set_ss(highest));
+            return _mm_cvtss_f32(_mm_and_ps(clamped, _mm_cmpord_ss(v, v)));
+        }
+    }
+#endif
+    return zero_unless(value == value, std::min(std::max(value, lowest), highest));
+}
+
+} // namespace __cast_detail
+
+//! Converts a float to an integer, truncating towards zero and clamping to the range of T. NaN becomes 0.
+template <std::integral T, ieee_float S>
+[[nodiscard]] constexpr T saturate_cast(const S value) noexcept
+{
+    constexpr auto lowest = __cast_detail::min_exact_value<T, S>();
+    constexpr auto highest = __cast_detail::max_exact_value<T, S>();
+
+    const auto result = static_cast<T>(__cast_detail::clamp_or_zero(value, lowest, highest));
+    if constexpr (std::numeric_limits<T>::digits > std::numeric_limits<S>::digits)
+    {
+        // No float lies between the largest one exactly representable in T and the maximum of T.
+        return value > highest ? std::numeric_limits<T>::max() : result;
+    }
+    else
+    {
+        return result;
+    }
+}
+
+//! Converts a float, clamping finite values to the finite range of T. Infinities and NaN are kept.
+template <ieee_float T, ieee_float S>
+[[nodiscard]] constexpr T saturate_cast(const S value) noexcept
+{
+    if constexpr (std::numeric_limits<T>::max() >= std::numeric_limits<S>::max())
+    {
+        return static_cast<T>(value);
+    }
+    else
+    {
+        constexpr auto lowest = static_cast<S>(std::numeric_limits<T>::lowest());
+        constexpr auto highest = static_cast<S>(std::numeric_limits<T>::max());
+        constexpr auto infinity = std::numeric_limits<S>::infinity();
+        const auto infinite = value == infinity || value == -infinity;
+        return static_cast<T>(infinite ? value : std::min(std::max(value, lowest), highest));
+    }
+}
+
+//! Converts the elements of source to the elements of target with saturate_cast, target must be at least as long
+//! as source. Between two AlignedBuffers the padding of target is overwritten.
+template <std::ranges::contiguous_range Source, std::ranges::contiguous_range Target>
+constexpr void saturate_cast(const Source & source, Target && target) noexcept
+    requires std::ranges::output_range<Target, std::ranges::range_value_t<Target>> &&
+             requires(std::ranges::range_value_t<Source> value) {
+                 saturate_cast<std::ranges::range_value_t<Target>>(value);
+             }
+{
+    using T = std::ranges::range_value_t<Target>;
+
+    AR_PRE(std::ranges::size(target) >= std::ranges::size(source));
+    if constexpr (aligned_buffer<Source> && aligned_buffer<Target>)
+    {
+        // The padding is converted too, so every vector is aligned and whole.
+        const auto padded = std::min(source.padded_size(), target.padded_size());
+        const auto * const from = source.data();
+        auto * const to = target.data();
+        for (size_t i = 0; i < padded; ++i)
+        {
+            to[i] = saturate_cast<T>(from[i]);
+        }
+    }
+    else
+    {
+        std::ranges::transform(
+            source,
+            std::ranges::begin(target),
+            [](const auto value) { return saturate_cast<T>(value); });
+    }
+}
+
 } // namespace ka
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <ka/common/assert.hpp>
+#include <ka/common/cast.hpp>
+#include <ka/common/fixed.hpp>
+
+namespace ka
+{
+
+namespace __charconv_detail
+{
+
+template <typename T>
+[[nodiscard]] consteval std::size_t max_number_chars() noexcept
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        return 1;
+    }
+    else if constexpr (std::integral<T>)
+    {
+        return std::numeric_limits<T>::digits10 + 1 + std::signed_integral<T>;
+    }
+    else
+    {
+        // Sign, digits, point and exponent of the longest shortest representation.
+        return std::numeric_limits<T>::max_digits10 + 8;
+    }
+}
+
+} // namespace __charconv_detail
+
+//! Characters write_number writes at most for a value of T.
+template <typename T>
+    requires std::integral<T> || ieee_float<T>
+constexpr std::size_t max_number_chars = __charconv_detail::max_number_chars<T>();
+
+namespace __charconv_detail
+{
+
+constexpr std::array<char, 200> digit_pairs = []
+{
+    std::array<char, 200> pairs {};
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+        pairs[2 * i] = static_cast<char>('0' + i / 10);
+        pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return pairs;
+}();
+
+constexpr std::array<u64, 20> powers_of_10 = []
+{
+    std::array<u64, 20> powers {};
+    u64 power = 1;
+    for (auto & value : powers)
+    {
+        value = power;
+        power *= 10;
+    }
+    return powers;
+}();
+
+[[nodiscard]] constexpr std::size_t count_digits(const u64 value) noexcept
+{
+    // Setting the lowest bit never changes the number of digits and makes 0 count as one.
+    const auto odd = value | 1;
+    // 1233 / 4096 approximates log10(2), the estimate is exact or one too large.
+    const auto estimate = static_cast<std::size_t>(std::bit_width(odd) * 1233 >> 12);
+    return estimate + 1 - (odd < powers_of_10[estimate]);
+}
+
+//! Writes the digits of value backwards from end, two at a time.
+constexpr void write_digits_backwards(char * end, u64 value) noexcept
+{
+    while (value >= 100)
+    {
+        const auto pair = static_cast<std::size_t>(value % 100) * 2;
+        value /= 100;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    if (value >= 10)
+    {
+        const auto pair = static_cast<std::size_t>(value) * 2;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    else
+    {
+        *--end = static_cast<char>('0' + value);
+    }
+}
+
+} // namespace __charconv_detail
+
+//! Writes value in decimal to out, which must have room for max_number_chars<T> characters, and returns the end.
+//! Integers are written two digits at a time from a table, floats in the shortest form which parses back to the
+//! same value, like std::to_chars. Booleans are written as 0 or 1.
+template <typename T>
+    requires std::integral<T> || ieee_float<T>
+constexpr char * write_number(char * out, const T value) noexcept
+{
+    if constexpr (std::integral<T>)
+    {
+        using U = std::make_unsigned_t<std::conditional_t<std::is_same_v<T, bool>, u8, T>>;
+        auto magnitude = static_cast<u64>(static_cast<U>(value));
+        if constexpr (std::signed_integral<T>)
+        {
+            if (value < 0)
+            {
+                *out++ = '-';
+                // Negated in the unsigned type, so the minimum doesn't overflow.
+                magnitude = static_cast<u64>(static_cast<U>(U {} - static_cast<U>(value)));
+            }
+        }
+        const auto digits = __charconv_detail::count_digits(magnitude);
+        __charconv_detail::write_digits_backwards(out + digits, magnitude);
+        return out + digits;
+    }
+    else
+    {
+        const auto result = std::to_chars(out, out + max_number_chars<T>, value);
+        AR_POST(result.ec == std::errc {});
+        return result.ptr;
+    }
+}
+
+//! Writes exactly digits decimal digits of value to out, padded with zeros, and returns the end.
+//! The value must have at most digits digits.
+template <std::unsigned_integral T>
+constexpr char * write_digits(char * const out, const T value, const std::size_t digits) noexcept
+{
+    AR_PRE(digits >= __charconv_detail::count_digits(value));
+    const auto length = __charconv_detail::count_digits(value);
+    std::fill_n(out, digits - length, '0');
+    __charconv_detail::write_digits_backwards(out + digits, value);
+    return out + digits;
+}
+
+//! Appends value to a buffer with append(const char *, const char *), like fmt::memory_buffer which the log
+//! backend formats into, without going through a format string.
+template <typename Buffer, typename T>
+    requires std::integral<T> || ieee_float<T>
+void append_number(Buffer & out, const T value)
+{
+    std::array<char, max_number_chars<T>> chars;
+    out.append(chars.data(), write_number(chars.data(), value));
+}
+
+namespace __charconv_detail
+{
+
+[[nodiscard]] constexpr bool is_digit(const char c) noexcept
+{
+    return c >= '0' && c <= '9';
+}
+
+//! Parses a float with an integral value, such as "1.0" or "25e2", without rounding: digits after the point must be
+//! zeros.
+template <std::integral T>
+[[nodiscard]] constexpr std::optional<T> parse_integral_float(const char * const begin, const char * const end) noexcept
+{
+    const bool negative = begin != end && *begin == '-';
+    const auto * next = begin + negative;
+    const auto * const integer = next;
+    while (next != end && is_digit(*next))
+    {
+        ++next;
+    }
+    const auto integer_digits = next - integer;
+    const auto * fraction = next;
+    if (next != end && *next == '.')
+    {
+        fraction = ++next;
+        while (next != end && is_digit(*next))
+        {
+            ++next;
+        }
+    }
+    const auto fraction_digits = next - fraction;
+    if (integer_digits + fraction_digits == 0)
+    {
+        return std::nullopt;
+    }
+
+    // Exponents are clamped, beyond the limit every number is zero or out of range anyway.
+    constexpr s64 max_exponent = 1'000'000;
+    s64 exponent = 0;
+    if (next != end && (*next == 'e' || *next == 'E'))
+    {
+        ++next;
+        const bool negative_exponent = next != end && *next == '-';
+        next += next != end && (*next == '-' || *next == '+');
+        if (next == end || !is_digit(*next))
+        {
+            return std::nullopt;
+        }
+        for (; next != end && is_digit(*next); ++next)
+        {
+            exponent = std::min(exponent * 10 + (*next - '0'), max_exponent);
+        }
+        exponent = negative_exponent ? -exponent : exponent;
+    }
+    if (next != end)
+    {
+        return std::nullopt;
+    }
+
+    // Digits before the point are accumulated, the ones after it must be zeros.
+    const auto point = integer_digits + exponent;
+    u64 magnitude = 0;
+    const auto push = [&](const u64 digit)
+    {
+        if (magnitude > (std::numeric_limits<u64>::max() - digit) / 10)
+        {
+            return false;
+        }
+        magnitude = magnitude * 10 + digit;
+        return true;
+    };
+    for (s64 i = 0; i < integer_digits + fraction_digits; ++i)
+    {
+        const auto digit = static_cast<u64>((i < integer_digits ? integer[i] : fraction[i - integer_digits]) - '0');
+        if (i >= point ? digit != 0 : !push(digit))
+        {
+            return std::nullopt;
+        }
+    }
+    for (auto i = integer_digits + fraction_digits; i < point && magnitude != 0; ++i)
+    {
+        if (!push(0))
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (!negative)
+    {
+        return std::in_range<T>(magnitude) ? std::optional<T>(static_cast<T>(magnitude)) : std::nullopt;
+    }
+    constexpr auto max_negative = static_cast<u64>(std::numeric_limits<s64>::max()) + 1;
+    if (magnitude > max_negative)
+    {
+        return std::nullopt;
+    }
+    const auto value = magnitude == max_negative ? std::numeric_limits<s64>::min() : -static_cast<s64>(magnitude);
+    return std::in_range<T>(value) ? std::optional<T>(static_cast<T>(value)) : std::nullopt;
+}
+
+} // namespace __charconv_detail
+
+//! Parses the whole text as a decimal number and returns it if T represents it exactly, std::nullopt otherwise.
+//! Validation happens while parsing: parse_exact<s32>(text) fails on anything outside of s32 or with a fraction,
+//! but accepts integral floats such as "1e3". Floats accept any decimal rounded to nearest and fail if it overflows,
+//! except that integers in the range of s64 written without a point or exponent must be exactly representable, like
+//! for exact_cast int -> float. Leading whitespace and '+' are rejected, as by std::from_chars.
+template <typename T>
+    requires(std::integral<T> && !std::is_same_v<T, bool>) || ieee_float<T>
+[[nodiscard]] std::optional<T> parse_exact(const std::string_view text) noexcept
+{
+    const auto * const begin = text.data();
+    const auto * const end = begin + text.size();
+    if constexpr (std::integral<T>)
+    {
+        T value;
+        const auto result = std::from_chars(begin, end, value);
+        if (result.ec == std::errc {} && result.ptr == end)
+        {
+            return value;
+        }
+        // Integers written as floats, anything else fails there too.
+        return __charconv_detail::parse_integral_float<T>(begin, end);
+    }
+    else
+    {
+        using Integer = std::conditional_t<sizeof(T) <= sizeof(s32), s32, s64>;
+        Integer integer;
+        if (const auto result = std::from_chars(begin, end, integer);
+            result.ec == std::errc {} && result.ptr == end)
+        {
+            return try_exact_cast<T>(integer);
+        }
+        T value;
+        const auto result = std::from_chars(begin, end, value, std::chars_format::general);
+        if (result.ec != std::errc {} || result.ptr != end)
+        {
+            return std::nullopt;
+        }
+        return value;
+    }
+}
+
+} // namespace ka
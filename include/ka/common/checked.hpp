@@ -0,0 +1,211 @@
+#pragma once
+
+#include <concepts>
+#include <limits>
+#include <source_location>
+#include <type_traits>
+
+#include <ka/common/assert.hpp>
+#include <ka/common/fixed.hpp>
+
+namespace ka
+{
+
+//! Integer types of checked arithmetic, bool is not one of them.
+template <typename T>
+concept checked_integral = std::integral<T> && !std::same_as<T, bool>;
+
+namespace __checked_detail
+{
+
+template <checked_integral T>
+[[nodiscard]] constexpr bool add_overflow(const T a, const T b, T & result) noexcept
+{
+#if defined(__GNUC__)
+    // GCC rejects overflowing builtins on types narrower than int in constant expressions.
+    if (!std::is_constant_evaluated())
+    {
+        return __builtin_add_overflow(a, b, &result);
+    }
+#endif
+    // Unsigned arithmetic wraps, signed overflow is detected before it happens.
+    using U = std::make_unsigned_t<T>;
+    result = static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+    if constexpr (std::is_signed_v<T>)
+    {
+        return b > 0 ? a > std::numeric_limits<T>::max() - b : a < std::numeric_limits<T>::min() - b;
+    }
+    else
+    {
+        return result < a;
+    }
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr bool sub_overflow(const T a, const T b, T & result) noexcept
+{
+#if defined(__GNUC__)
+    if (!std::is_constant_evaluated())
+    {
+        return __builtin_sub_overflow(a, b, &result);
+    }
+#endif
+    using U = std::make_unsigned_t<T>;
+    result = static_cast<T>(static_cast<U>(a) - static_cast<U>(b));
+    if constexpr (std::is_signed_v<T>)
+    {
+        return b < 0 ? a > std::numeric_limits<T>::max() + b : a < std::numeric_limits<T>::min() + b;
+    }
+    else
+    {
+        return a < b;
+    }
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr bool mul_overflow(const T a, const T b, T & result) noexcept
+{
+#if defined(__GNUC__)
+    if (!std::is_constant_evaluated())
+    {
+        return __builtin_mul_overflow(a, b, &result);
+    }
+#endif
+    // Unsigned types narrower than int are promoted to int, whose product may overflow.
+    using U = std::common_type_t<std::make_unsigned_t<T>, unsigned>;
+    result = static_cast<T>(static_cast<U>(a) * static_cast<U>(b));
+    if (a == 0 || b == 0)
+    {
+        return false;
+    }
+    if constexpr (std::is_signed_v<T>)
+    {
+        constexpr auto max = std::numeric_limits<T>::max();
+        constexpr auto min = std::numeric_limits<T>::min();
+        if (a > 0)
+        {
+            return b > 0 ? a > max / b : b < min / a;
+        }
+        return b > 0 ? a < min / b : a < max / b;
+    }
+    else
+    {
+        return a > std::numeric_limits<T>::max() / b;
+    }
+}
+
+//! The bound an overflowing operation crossed, negative tells the sign of its exact result if T is signed.
+template <checked_integral T>
+[[nodiscard]] constexpr T saturation_bound(const bool negative) noexcept
+{
+    return negative ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr bool is_negative(const T value) noexcept
+{
+    if constexpr (std::is_signed_v<T>)
+    {
+        return value < 0;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+} // namespace __checked_detail
+
+//! Stores a + b in result and returns true, or returns false if the sum is out of the range of T. The result is
+//! the wrapped sum in that case. Never asserts.
+template <checked_integral T>
+[[nodiscard]] constexpr bool try_add(const T a, const std::type_identity_t<T> b, T & result) noexcept
+{
+    return !__checked_detail::add_overflow(a, b, result);
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr bool try_sub(const T a, const std::type_identity_t<T> b, T & result) noexcept
+{
+    return !__checked_detail::sub_overflow(a, b, result);
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr bool try_mul(const T a, const std::type_identity_t<T> b, T & result) noexcept
+{
+    return !__checked_detail::mul_overflow(a, b, result);
+}
+
+//! Returns a + b, asserting that the sum is in the range of T like exact_cast. Wraps if assertions are disabled.
+template <checked_integral T>
+[[nodiscard]] constexpr T checked_add(
+    const T a,
+    const std::type_identity_t<T> b,
+    const std::source_location & location = std::source_location::current()) noexcept
+{
+    T result;
+    [[maybe_unused]] const bool overflow = __checked_detail::add_overflow(a, b, result);
+    AR_NESTED_ASSERT(!overflow, "checked_add", location);
+    return result;
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr T checked_sub(
+    const T a,
+    const std::type_identity_t<T> b,
+    const std::source_location & location = std::source_location::current()) noexcept
+{
+    T result;
+    [[maybe_unused]] const bool overflow = __checked_detail::sub_overflow(a, b, result);
+    AR_NESTED_ASSERT(!overflow, "checked_sub", location);
+    return result;
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr T checked_mul(
+    const T a,
+    const std::type_identity_t<T> b,
+    const std::source_location & location = std::source_location::current()) noexcept
+{
+    T result;
+    [[maybe_unused]] const bool overflow = __checked_detail::mul_overflow(a, b, result);
+    AR_NESTED_ASSERT(!overflow, "checked_mul", location);
+    return result;
+}
+
+//! Returns a + b clamped to the range of T.
+template <checked_integral T>
+[[nodiscard]] constexpr T saturating_add(const T a, const std::type_identity_t<T> b) noexcept
+{
+    T result;
+    if (__checked_detail::add_overflow(a, b, result))
+    {
+        return __checked_detail::saturation_bound<T>(__checked_detail::is_negative(b));
+    }
+    return result;
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr T saturating_sub(const T a, const std::type_identity_t<T> b) noexcept
+{
+    T result;
+    if (__checked_detail::sub_overflow(a, b, result))
+    {
+        return __checked_detail::saturation_bound<T>(std::is_unsigned_v<T> || b > 0);
+    }
+    return result;
+}
+
+template <checked_integral T>
+[[nodiscard]] constexpr T saturating_mul(const T a, const std::type_identity_t<T> b) noexcept
+{
+    T result;
+    if (__checked_detail::mul_overflow(a, b, result))
+    {
+        const bool negative = __checked_detail::is_negative(a) != __checked_detail::is_negative(b);
+        return __checked_detail::saturation_bound<T>(negative);
+    }
+    return result;
+}
+
+} // namespace ka
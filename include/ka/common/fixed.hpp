@@ -1,8 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 namespace ka
 {
@@ -29,4 +37,174 @@ static_assert(ieee_float<f64>);
 static_assert(std::numeric_limits<f32>::digits == 24);
 static_assert(std::numeric_limits<f64>::digits == 53);
 
+constexpr std::size_t cache_line_size = 64;
+
+//! Bytes in the widest vector registers of the target: AVX-512, AVX, SSE2 or NEON, a general purpose register
+//! without them.
+constexpr std::size_t native_vector_size =
+#if defined(__AVX512F__)
+    64;
+#elif defined(__AVX__)
+    32;
+#elif defined(__SSE2__) || defined(_M_X64) || defined(__ARM_NEON)
+    16;
+#else
+    sizeof(u64);
+#endif
+
+//! Elements of T in a native vector.
+template <typename T>
+    requires std::is_arithmetic_v<T>
+constexpr std::size_t native_lanes = std::max<std::size_t>(native_vector_size / sizeof(T), 1);
+
+//! Heap array of value-initialized elements aligned to Alignment bytes and padded to a multiple of Alignment bytes.
+//! The padding is value-initialized too and may be written, so vector loops may run over padded_size() elements,
+//! where no vector is partial. Bulk casts and hash_batch have fast paths for pairs of these buffers.
+template <typename T, std::size_t Alignment = std::max(native_vector_size, alignof(T))>
+    requires std::is_trivially_copyable_v<T> && (std::has_single_bit(Alignment)) && (Alignment >= alignof(T)) &&
+             (Alignment % sizeof(T) == 0)
+class AlignedBuffer final
+{
+public:
+    using value_type = T;
+
+    constexpr static std::size_t alignment = Alignment;
+    //! Padded sizes are multiples of it.
+    constexpr static std::size_t granule = Alignment / sizeof(T);
+
+public:
+    AlignedBuffer() noexcept = default;
+
+    //! Throws std::bad_alloc if the memory can't be allocated.
+    explicit AlignedBuffer(const std::size_t size)
+        : size_(size)
+    {
+        if (size_ != 0)
+        {
+            data_ = static_cast<T *>(::operator new(padded_size() * sizeof(T), std::align_val_t { Alignment }));
+            std::uninitialized_value_construct_n(data_, padded_size());
+        }
+    }
+
+    AlignedBuffer(const AlignedBuffer & other)
+        : AlignedBuffer(other.size_)
+    {
+        std::copy_n(other.data_, padded_size(), data_);
+    }
+
+    AlignedBuffer(AlignedBuffer && other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    AlignedBuffer & operator=(AlignedBuffer other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    ~AlignedBuffer()
+    {
+        if (data_ != nullptr)
+        {
+            ::operator delete(data_, std::align_val_t { Alignment });
+        }
+    }
+
+    [[nodiscard]] T * data() noexcept
+    {
+        return std::assume_aligned<Alignment>(data_);
+    }
+
+    [[nodiscard]] const T * data() const noexcept
+    {
+        return std::assume_aligned<Alignment>(data_);
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    //! Size rounded up to a multiple of granule.
+    [[nodiscard]] std::size_t padded_size() const noexcept
+    {
+        return (size_ + granule - 1) / granule * granule;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] T * begin() noexcept
+    {
+        return data_;
+    }
+
+    [[nodiscard]] const T * begin() const noexcept
+    {
+        return data_;
+    }
+
+    [[nodiscard]] T * end() noexcept
+    {
+        return data_ + size_;
+    }
+
+    [[nodiscard]] const T * end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    [[nodiscard]] T & operator[](const std::size_t i) noexcept
+    {
+        return data_[i];
+    }
+
+    [[nodiscard]] const T & operator[](const std::size_t i) const noexcept
+    {
+        return data_[i];
+    }
+
+    //! The elements and the padding.
+    [[nodiscard]] std::span<T> padded_span() noexcept
+    {
+        return { data_, padded_size() };
+    }
+
+    [[nodiscard]] std::span<const T> padded_span() const noexcept
+    {
+        return { data_, padded_size() };
+    }
+
+private:
+    T * data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+//! Buffer whose elements never share a cache line with other data.
+template <typename T>
+using CacheAlignedBuffer = AlignedBuffer<T, std::max(cache_line_size, alignof(T))>;
+
+namespace __fixed_detail
+{
+
+template <typename T>
+struct IsAlignedBuffer : std::false_type
+{
+};
+
+template <typename T, std::size_t Alignment>
+struct IsAlignedBuffer<AlignedBuffer<T, Alignment>> : std::true_type
+{
+};
+
+} // namespace __fixed_detail
+
+template <typename R>
+concept aligned_buffer = __fixed_detail::IsAlignedBuffer<std::remove_cvref_t<R>>::value;
+
 } // namespace ka
@@ -0,0 +1,885 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include <ka/common/fixed.hpp>
+#include <ka/common/hash.hpp>
+
+namespace ka
+{
+
+namespace __flat_hash_detail
+{
+
+//! Control byte of a slot: the low 7 bits of the hash of a full slot, or one of the negative markers.
+enum class Ctrl : s8
+{
+    empty = -128,
+    deleted = -2,
+};
+
+[[nodiscard]] constexpr bool is_full(const s8 ctrl) noexcept
+{
+    return ctrl >= 0;
+}
+
+//! Set bits mark slots of a group, each slot takes `1 << Shift` bits.
+template <int Shift>
+class BitMask final
+{
+public:
+    explicit constexpr BitMask(const u64 bits) noexcept
+        : bits_(bits)
+    {
+    }
+
+    [[nodiscard]] constexpr explicit operator bool() const noexcept
+    {
+        return bits_ != 0;
+    }
+
+    //! Index of the first marked slot, the mask must not be empty.
+    [[nodiscard]] constexpr size_t lowest() const noexcept
+    {
+        return static_cast<size_t>(std::countr_zero(bits_)) >> Shift;
+    }
+
+    constexpr void clear_lowest() noexcept
+    {
+        bits_ &= bits_ - 1;
+    }
+
+private:
+    u64 bits_;
+};
+
+#if defined(__SSE2__) || defined(_M_X64)
+
+//! Control bytes of 16 consecutive slots compared at once.
+class Group final
+{
+public:
+    constexpr static size_t width = 16;
+
+    explicit Group(const s8 * const ctrl) noexcept
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl)))
+    {
+    }
+
+    [[nodiscard]] BitMask<0> match(const s8 h2) const noexcept
+    {
+        return mask(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2)));
+    }
+
+    [[nodiscard]] BitMask<0> match_empty() const noexcept
+    {
+        return mask(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(static_cast<s8>(Ctrl::empty))));
+    }
+
+    //! Markers are the only negative control bytes.
+    [[nodiscard]] BitMask<0> match_empty_or_deleted() const noexcept
+    {
+        return mask(ctrl_);
+    }
+
+private:
+    [[nodiscard]] static BitMask<0> mask(const __m128i bytes) noexcept
+    {
+        return BitMask<0>(static_cast<u16>(_mm_movemask_epi8(bytes)));
+    }
+
+private:
+    __m128i ctrl_;
+};
+
+#elif defined(__ARM_NEON)
+
+//! Control bytes of 8 consecutive slots compared at once, a match sets the high bit of its byte.
+class Group final
+{
+public:
+    constexpr static size_t width = 8;
+
+    explicit Group(const s8 * const ctrl) noexcept
+        : ctrl_(vld1_s8(ctrl))
+    {
+    }
+
+    [[nodiscard]] BitMask<3> match(const s8 h2) const noexcept
+    {
+        return mask(vceq_s8(ctrl_, vdup_n_s8(h2)));
+    }
+
+    [[nodiscard]] BitMask<3> match_empty() const noexcept
+    {
+        return mask(vceq_s8(ctrl_, vdup_n_s8(static_cast<s8>(Ctrl::empty))));
+    }
+
+    [[nodiscard]] BitMask<3> match_empty_or_deleted() const noexcept
+    {
+        return mask(vreinterpret_u8_s8(ctrl_));
+    }
+
+private:
+    [[nodiscard]] static BitMask<3> mask(const uint8x8_t bytes) noexcept
+    {
+        return BitMask<3>(vget_lane_u64(vreinterpret_u64_u8(bytes), 0) & 0x8080808080808080);
+    }
+
+private:
+    int8x8_t ctrl_;
+};
+
+#else
+
+//! Control bytes of 8 consecutive slots compared at once in a 64-bit word, a match sets the high bit of its byte.
+class Group final
+{
+public:
+    constexpr static size_t width = 8;
+
+    explicit Group(const s8 * const ctrl) noexcept
+    {
+        std::memcpy(&ctrl_, ctrl, sizeof(ctrl_));
+        if constexpr (std::endian::native == std::endian::big)
+        {
+            ctrl_ = byte_swap(ctrl_);
+        }
+    }
+
+    //! May report a false match next to a true one, keys of matches are compared anyway.
+    [[nodiscard]] BitMask<3> match(const s8 h2) const noexcept
+    {
+        const auto bytes = ctrl_ ^ (lsbs * static_cast<u8>(h2));
+        return BitMask<3>((bytes - lsbs) & ~bytes & msbs);
+    }
+
+    //! Empty is the only marker with bit 1 clear.
+    [[nodiscard]] BitMask<3> match_empty() const noexcept
+    {
+        return BitMask<3>(ctrl_ & ~(ctrl_ << 6) & msbs);
+    }
+
+    [[nodiscard]] BitMask<3> match_empty_or_deleted() const noexcept
+    {
+        return BitMask<3>(ctrl_ & msbs);
+    }
+
+private:
+    constexpr static u64 lsbs = 0x0101010101010101;
+    constexpr static u64 msbs = 0x8080808080808080;
+
+private:
+    [[nodiscard]] static u64 byte_swap(u64 value) noexcept
+    {
+        u64 result = 0;
+        for (size_t i = 0; i < sizeof(value); ++i, value >>= 8)
+        {
+            result = (result << 8) | (value & 0xff);
+        }
+        return result;
+    }
+
+private:
+    u64 ctrl_;
+};
+
+#endif
+
+template <typename H, typename E>
+concept Transparent = requires {
+    typename H::is_transparent;
+    typename E::is_transparent;
+};
+
+//! Open-addressing table of Slot in the style of Swiss tables.
+//! Every slot has a control byte holding 7 bits of the hash of its key, lookups compare the control bytes of a
+//! whole group of slots at once and only compare keys on a match. Groups are probed quadratically.
+//! KeyOf::get(const Slot &) returns the key of a slot.
+template <typename Key, typename Slot, typename KeyOf, typename H, typename E>
+class Table
+{
+public:
+    //! Each slot points into the table, they are invalidated by inserts which grow it and by rehash().
+    template <bool Const>
+    class Iterator final
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Slot;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const Slot *, Slot *>;
+        using reference = std::conditional_t<Const, const Slot &, Slot &>;
+
+        Iterator() noexcept = default;
+
+        //! Converts iterator to const_iterator.
+        template <bool OtherConst>
+            requires(Const && !OtherConst)
+        Iterator(const Iterator<OtherConst> & other) noexcept
+            : ctrl_(other.ctrl_)
+            , end_(other.end_)
+            , slot_(other.slot_)
+        {
+        }
+
+        [[nodiscard]] reference operator*() const noexcept
+        {
+            return *slot_;
+        }
+
+        [[nodiscard]] pointer operator->() const noexcept
+        {
+            return slot_;
+        }
+
+        Iterator & operator++() noexcept
+        {
+            ++ctrl_;
+            ++slot_;
+            skip_free();
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept
+        {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+
+        [[nodiscard]] bool operator==(const Iterator & other) const noexcept
+        {
+            return ctrl_ == other.ctrl_;
+        }
+
+    private:
+        friend class Table;
+        template <bool>
+        friend class Iterator;
+
+        Iterator(const s8 * const ctrl, const s8 * const end, pointer const slot) noexcept
+            : ctrl_(ctrl)
+            , end_(end)
+            , slot_(slot)
+        {
+        }
+
+        void skip_free() noexcept
+        {
+            while (ctrl_ != end_ && !is_full(*ctrl_))
+            {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+    private:
+        const s8 * ctrl_ = nullptr;
+        const s8 * end_ = nullptr;
+        pointer slot_ = nullptr;
+    };
+
+    using key_type = Key;
+    using value_type = Slot;
+    using size_type = size_t;
+    using hasher = H;
+    using key_equal = E;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+public:
+    Table() noexcept(std::is_nothrow_default_constructible_v<H> && std::is_nothrow_default_constructible_v<E>) =
+        default;
+
+    explicit Table(const size_t capacity, const H & hash = H(), const E & eq = E())
+        : hash_(hash)
+        , eq_(eq)
+    {
+        reserve(capacity);
+    }
+
+    Table(const Table & other)
+        : hash_(other.hash_)
+        , eq_(other.eq_)
+    {
+        reserve(other.size_);
+        for (const auto & slot : other)
+        {
+            const auto hash = hash_of(KeyOf::get(slot));
+            const auto index = prepare_insert(hash);
+            std::construct_at(slots_ + index, slot);
+            commit_insert(index, hash);
+        }
+    }
+
+    Table(Table && other) noexcept
+        : hash_(std::move(other.hash_))
+        , eq_(std::move(other.eq_))
+    {
+        swap_storage(other);
+    }
+
+    Table & operator=(const Table & other)
+    {
+        if (this != &other)
+        {
+            auto copy = other;
+            swap(copy);
+        }
+        return *this;
+    }
+
+    Table & operator=(Table && other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            hash_ = std::move(other.hash_);
+            eq_ = std::move(other.eq_);
+            swap_storage(other);
+        }
+        return *this;
+    }
+
+    ~Table()
+    {
+        destroy();
+    }
+
+    void swap(Table & other) noexcept
+    {
+        using std::swap;
+        swap(hash_, other.hash_);
+        swap(eq_, other.eq_);
+        swap_storage(other);
+    }
+
+    [[nodiscard]] iterator begin() noexcept
+    {
+        iterator result(ctrl_, ctrl_ + capacity_, slots_);
+        result.skip_free();
+        return result;
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept
+    {
+        const_iterator result(ctrl_, ctrl_ + capacity_, slots_);
+        result.skip_free();
+        return result;
+    }
+
+    [[nodiscard]] iterator end() noexcept
+    {
+        return { ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_ };
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept
+    {
+        return { ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_ };
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    //! Number of slots, at most 7/8 of them are used before the table grows.
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    //! Destroys the elements and keeps the slots.
+    void clear() noexcept
+    {
+        destroy_slots();
+        if (capacity_ != 0)
+        {
+            std::memset(ctrl_, static_cast<s8>(Ctrl::empty), capacity_ + Group::width);
+        }
+        size_ = 0;
+        growth_left_ = max_load(capacity_);
+    }
+
+    //! Makes room for `count` elements without growing.
+    void reserve(const size_t count)
+    {
+        if (count > size_ + growth_left_)
+        {
+            rehash(capacity_for(count));
+        }
+    }
+
+    [[nodiscard]] iterator find(const Key & key) noexcept
+    {
+        return to_iterator(find_index(key));
+    }
+
+    [[nodiscard]] const_iterator find(const Key & key) const noexcept
+    {
+        return to_iterator(find_index(key));
+    }
+
+    template <typename Q>
+        requires Transparent<H, E>
+    [[nodiscard]] iterator find(const Q & key) noexcept
+    {
+        return to_iterator(find_index(key));
+    }
+
+    template <typename Q>
+        requires Transparent<H, E>
+    [[nodiscard]] const_iterator find(const Q & key) const noexcept
+    {
+        return to_iterator(find_index(key));
+    }
+
+    [[nodiscard]] bool contains(const Key & key) const noexcept
+    {
+        return find_index(key) != capacity_;
+    }
+
+    template <typename Q>
+        requires Transparent<H, E>
+    [[nodiscard]] bool contains(const Q & key) const noexcept
+    {
+        return find_index(key) != capacity_;
+    }
+
+    //! Returns the number of erased elements, 0 or 1.
+    size_t erase(const Key & key) noexcept
+    {
+        return erase_key(key);
+    }
+
+    template <typename Q>
+        requires Transparent<H, E> && (!std::convertible_to<const Q &, const_iterator>)
+    size_t erase(const Q & key) noexcept
+    {
+        return erase_key(key);
+    }
+
+    //! Other iterators stay valid.
+    void erase(const const_iterator position) noexcept
+    {
+        erase_index(static_cast<size_t>(position.ctrl_ - ctrl_));
+    }
+
+protected:
+    //! Finds the slot of the key or constructs one with make(slot pointer), which must construct a Slot there.
+    template <typename Q, typename F>
+    std::pair<iterator, bool> find_or_insert(const Q & key, F && make)
+    {
+        const auto hash = hash_of(key);
+        if (const auto index = find_index(key, hash); index != capacity_)
+        {
+            return { to_iterator(index), false };
+        }
+        const auto index = prepare_insert(hash);
+        std::forward<F>(make)(slots_ + index);
+        commit_insert(index, hash);
+        return { to_iterator(index), true };
+    }
+
+    [[nodiscard]] iterator to_iterator(const size_t index) noexcept
+    {
+        return { ctrl_ + index, ctrl_ + capacity_, slots_ + index };
+    }
+
+    [[nodiscard]] const_iterator to_iterator(const size_t index) const noexcept
+    {
+        return { ctrl_ + index, ctrl_ + capacity_, slots_ + index };
+    }
+
+private:
+    [[nodiscard]] constexpr static size_t max_load(const size_t capacity) noexcept
+    {
+        return capacity - capacity / 8;
+    }
+
+    [[nodiscard]] constexpr static size_t capacity_for(const size_t count) noexcept
+    {
+        auto capacity = Group::width;
+        while (max_load(capacity) < count)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    //! The hash is mixed once more, so weak hashes still spread in both the 7 control bits and the position.
+    template <typename Q>
+    [[nodiscard]] u64 hash_of(const Q & key) const noexcept
+    {
+        return __hash_detail::multiply_fold(static_cast<u64>(hash_(key)), __hash_detail::secret0);
+    }
+
+    [[nodiscard]] static s8 h2(const u64 hash) noexcept
+    {
+        return static_cast<s8>(hash & 0x7f);
+    }
+
+    [[nodiscard]] static size_t h1(const u64 hash) noexcept
+    {
+        return static_cast<size_t>(hash >> 7);
+    }
+
+    template <typename Q>
+    [[nodiscard]] size_t find_index(const Q & key) const noexcept
+    {
+        return find_index(key, hash_of(key));
+    }
+
+    //! Returns capacity_ if the key is absent.
+    template <typename Q>
+    [[nodiscard]] size_t find_index(const Q & key, const u64 hash) const noexcept
+    {
+        if (capacity_ == 0)
+        {
+            return capacity_;
+        }
+        const auto mask = capacity_ - 1;
+        auto position = h1(hash) & mask;
+        for (size_t step = Group::width;; step += Group::width)
+        {
+            const Group group(ctrl_ + position);
+            for (auto match = group.match(h2(hash)); match; match.clear_lowest())
+            {
+                const auto index = (position + match.lowest()) & mask;
+                if (eq_(KeyOf::get(slots_[index]), key))
+                {
+                    return index;
+                }
+            }
+            if (group.match_empty())
+            {
+                return capacity_;
+            }
+            position = (position + step) & mask;
+        }
+    }
+
+    //! Returns a free slot for the hash, growing the table if needed.
+    [[nodiscard]] size_t prepare_insert(const u64 hash)
+    {
+        if (capacity_ != 0)
+        {
+            const auto index = find_free(hash);
+            if (growth_left_ != 0 || static_cast<Ctrl>(ctrl_[index]) == Ctrl::deleted)
+            {
+                return index;
+            }
+        }
+        // Reclaim the deleted slots if they are a large part of the table, grow otherwise.
+        rehash(capacity_ != 0 && size_ < max_load(capacity_) / 2 ? capacity_ : capacity_for(size_ + 1));
+        return find_free(hash);
+    }
+
+    //! Marks a slot returned by prepare_insert and constructed since as full.
+    void commit_insert(const size_t index, const u64 hash) noexcept
+    {
+        if (static_cast<Ctrl>(ctrl_[index]) == Ctrl::empty)
+        {
+            --growth_left_;
+        }
+        set_ctrl(index, h2(hash));
+        ++size_;
+    }
+
+    //! Requires a non-empty table.
+    [[nodiscard]] size_t find_free(const u64 hash) const noexcept
+    {
+        const auto mask = capacity_ - 1;
+        auto position = h1(hash) & mask;
+        for (size_t step = Group::width;; step += Group::width)
+        {
+            if (const auto free = Group(ctrl_ + position).match_empty_or_deleted())
+            {
+                return (position + free.lowest()) & mask;
+            }
+            position = (position + step) & mask;
+        }
+    }
+
+    //! The first Group::width control bytes are repeated after the last one, so a group can start at any slot.
+    void set_ctrl(const size_t index, const s8 value) noexcept
+    {
+        ctrl_[index] = value;
+        if (index < Group::width)
+        {
+            ctrl_[capacity_ + index] = value;
+        }
+    }
+
+    template <typename Q>
+    size_t erase_key(const Q & key) noexcept
+    {
+        const auto index = find_index(key);
+        if (index == capacity_)
+        {
+            return 0;
+        }
+        erase_index(index);
+        return 1;
+    }
+
+    //! The slot becomes deleted rather than empty, lookups of keys placed after it must not stop there.
+    void erase_index(const size_t index) noexcept
+    {
+        std::destroy_at(slots_ + index);
+        set_ctrl(index, static_cast<s8>(Ctrl::deleted));
+        --size_;
+    }
+
+    void rehash(const size_t capacity)
+    {
+        auto * const old_ctrl = ctrl_;
+        auto * const old_slots = slots_;
+        const auto old_capacity = capacity_;
+
+        auto slots = std::allocator<Slot>().allocate(capacity);
+        try
+        {
+            ctrl_ = new s8[capacity + Group::width];
+        }
+        catch (...)
+        {
+            std::allocator<Slot>().deallocate(slots, capacity);
+            throw;
+        }
+        slots_ = slots;
+        capacity_ = capacity;
+        std::memset(ctrl_, static_cast<s8>(Ctrl::empty), capacity + Group::width);
+        growth_left_ = max_load(capacity) - size_;
+
+        for (size_t i = 0; i < old_capacity; ++i)
+        {
+            if (is_full(old_ctrl[i]))
+            {
+                const auto hash = hash_of(KeyOf::get(old_slots[i]));
+                const auto index = find_free(hash);
+                std::construct_at(slots_ + index, std::move(old_slots[i]));
+                std::destroy_at(old_slots + i);
+                set_ctrl(index, h2(hash));
+            }
+        }
+        if (old_capacity != 0)
+        {
+            std::allocator<Slot>().deallocate(old_slots, old_capacity);
+            delete[] old_ctrl;
+        }
+    }
+
+    void destroy_slots() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<Slot>)
+        {
+            for (size_t i = 0; i < capacity_; ++i)
+            {
+                if (is_full(ctrl_[i]))
+                {
+                    std::destroy_at(slots_ + i);
+                }
+            }
+        }
+    }
+
+    void destroy() noexcept
+    {
+        if (capacity_ != 0)
+        {
+            destroy_slots();
+            std::allocator<Slot>().deallocate(slots_, capacity_);
+            delete[] ctrl_;
+        }
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+        growth_left_ = 0;
+    }
+
+    void swap_storage(Table & other) noexcept
+    {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+    }
+
+private:
+    s8 * ctrl_ = nullptr;
+    Slot * slots_ = nullptr;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    //! Empty slots which may be used before the table grows.
+    size_t growth_left_ = 0;
+    [[no_unique_address]] H hash_;
+    [[no_unique_address]] E eq_;
+};
+
+struct SetKeyOf final
+{
+    template <typename K>
+    [[nodiscard]] static const K & get(const K & slot) noexcept
+    {
+        return slot;
+    }
+};
+
+struct MapKeyOf final
+{
+    template <typename K, typename V>
+    [[nodiscard]] static const K & get(const std::pair<K, V> & slot) noexcept
+    {
+        return slot.first;
+    }
+};
+
+} // namespace __flat_hash_detail
+
+//! Open-addressing hash set storing the keys in one array, see __flat_hash_detail::Table.
+//! Digests of the table are never stored, so it hashes with MixHasher by default.
+//! Use StrHash and StrEq for heterogeneous lookup of strings.
+template <typename K, typename H = Hash<MixHasher>, typename E = std::equal_to<K>>
+class FlatHashSet final : public __flat_hash_detail::Table<K, K, __flat_hash_detail::SetKeyOf, H, E>
+{
+    using Base = __flat_hash_detail::Table<K, K, __flat_hash_detail::SetKeyOf, H, E>;
+
+public:
+    using Base::Base;
+    using typename Base::iterator;
+
+    std::pair<iterator, bool> insert(const K & key)
+    {
+        return this->find_or_insert(key, [&key](K * const slot) { std::construct_at(slot, key); });
+    }
+
+    std::pair<iterator, bool> insert(K && key)
+    {
+        return this->find_or_insert(key, [&key](K * const slot) { std::construct_at(slot, std::move(key)); });
+    }
+
+    //! Inserts K(key) unless an equal key is present, without constructing K for the lookup.
+    template <typename Q>
+        requires __flat_hash_detail::Transparent<H, E> && std::constructible_from<K, Q &&>
+    std::pair<iterator, bool> insert(Q && key)
+    {
+        return this->find_or_insert(
+            key,
+            [&key](K * const slot) { std::construct_at(slot, std::forward<Q>(key)); });
+    }
+};
+
+//! Open-addressing hash map storing the elements in one array, see __flat_hash_detail::Table.
+//! Elements are std::pair<K, V>, their keys must not be modified. Hashes with MixHasher by default.
+//! Use StrHash and StrEq for heterogeneous lookup of strings.
+template <typename K, typename V, typename H = Hash<MixHasher>, typename E = std::equal_to<K>>
+class FlatHashMap final : public __flat_hash_detail::Table<K, std::pair<K, V>, __flat_hash_detail::MapKeyOf, H, E>
+{
+    using Base = __flat_hash_detail::Table<K, std::pair<K, V>, __flat_hash_detail::MapKeyOf, H, E>;
+
+public:
+    using mapped_type = V;
+    using Base::Base;
+    using typename Base::iterator;
+
+    //! Constructs V from args only if the key is absent.
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K & key, Args &&... args)
+    {
+        return emplace_key(key, key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K && key, Args &&... args)
+    {
+        return emplace_key(key, std::move(key), std::forward<Args>(args)...);
+    }
+
+    template <typename Q, typename... Args>
+        requires __flat_hash_detail::Transparent<H, E> && std::constructible_from<K, Q &&>
+    std::pair<iterator, bool> try_emplace(Q && key, Args &&... args)
+    {
+        return emplace_key(key, std::forward<Q>(key), std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<K, V> & value)
+    {
+        return try_emplace(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(std::pair<K, V> && value)
+    {
+        return try_emplace(std::move(value.first), std::move(value.second));
+    }
+
+    //! Inserts or replaces the value.
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const K & key, M && value)
+    {
+        auto result = try_emplace(key, std::forward<M>(value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<M>(value);
+        }
+        return result;
+    }
+
+    V & operator[](const K & key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    V & operator[](K && key)
+    {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    template <typename Q>
+        requires __flat_hash_detail::Transparent<H, E> && std::constructible_from<K, Q &&>
+    V & operator[](Q && key)
+    {
+        return try_emplace(std::forward<Q>(key)).first->second;
+    }
+
+private:
+    template <typename Q, typename KeyArg, typename... Args>
+    std::pair<iterator, bool> emplace_key(const Q & lookup, KeyArg && key, Args &&... args)
+    {
+        return this->find_or_insert(
+            lookup,
+            [&](std::pair<K, V> * const slot)
+            {
+                std::construct_at(
+                    slot,
+                    std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<KeyArg>(key)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+    }
+};
+
+} // namespace ka
@@ -1,32 +1,277 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstring>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include <ka/common/assert.hpp>
 #include <ka/common/fixed.hpp>
 
 namespace ka
 {
 
-class Hasher;
+class Fnv1aHasher;
+class MixHasher;
+class WyHasher;
+class StripeHasher;
+//! The default hasher, its digests are stable.
+using Hasher = Fnv1aHasher;
 template <typename T>
 struct HashImpl;
 
-template <typename T>
-concept Hashable = requires(Hasher & hasher, const T & value) { HashImpl<T>::update(hasher, value); };
-//! Types which declare method hash(Hasher &) are hashable.
-template <typename T>
-concept HashableByMethod = requires(Hasher & hasher, const T & value) { value.hash(hasher); };
+template <typename T, typename H = Hasher>
+concept Hashable = requires(H & hasher, const T & value) { HashImpl<T>::update(hasher, value); };
+//! Types which declare method hash(H &) are hashable by H. Declare `template <typename H> void hash(H &) const` to
+//! support every hasher.
+template <typename T, typename H = Hasher>
+concept HashableByMethod = requires(H & hasher, const T & value) { value.hash(hasher); };
+
+namespace __hash_detail
+{
+
+// Constants of wyhash.
+constexpr u64 secret0 = 0xa0761d6478bd642f;
+constexpr u64 secret1 = 0xe7037ed1a0b428db;
+constexpr u64 secret2 = 0x8ebc6af09c88c6e3;
+constexpr u64 secret3 = 0x589965cc75374cc3;
+
+//! A random number which differs between runs.
+[[nodiscard]] u64 generate_seed() noexcept;
+
+#ifdef __SIZEOF_INT128__
+__extension__ using u128 = unsigned __int128;
+#endif
+
+//! Folds the 128-bit product of a and b to 64 bits.
+[[nodiscard]] constexpr u64 multiply_fold(const u64 a, const u64 b) noexcept
+{
+#ifdef __SIZEOF_INT128__
+    const auto product = static_cast<u128>(a) * b;
+    return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+#else
+    const u64 a_low = a & 0xffffffff;
+    const u64 a_high = a >> 32;
+    const u64 b_low = b & 0xffffffff;
+    const u64 b_high = b >> 32;
+    const u64 low_low = a_low * b_low;
+    const u64 low_high = a_low * b_high;
+    const u64 high_low = a_high * b_low;
+    const u64 high_high = a_high * b_high;
+    const u64 middle = (low_low >> 32) + (low_high & 0xffffffff) + (high_low & 0xffffffff);
+    const u64 low = (low_low & 0xffffffff) | (middle << 32);
+    const u64 high = high_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+    return low ^ high;
+#endif
+}
+
+//! std::memcpy usable in constant expressions.
+constexpr void copy_bytes(u8 * const destination, const u8 * const source, const size_t size) noexcept
+{
+    if (std::is_constant_evaluated())
+    {
+        std::copy_n(source, size, destination);
+    }
+    else
+    {
+        std::memcpy(destination, source, size);
+    }
+}
+
+//! Loads a number in the native byte order, also in constant expressions.
+template <std::unsigned_integral T>
+[[nodiscard]] constexpr T load(const u8 * const data) noexcept
+{
+    if (std::is_constant_evaluated())
+    {
+        T result = 0;
+        for (size_t i = 0; i < sizeof(T); ++i)
+        {
+            const auto byte = std::endian::native == std::endian::little ? i : sizeof(T) - 1 - i;
+            result |= static_cast<T>(static_cast<T>(data[i]) << (8 * byte));
+        }
+        return result;
+    }
+    T result;
+    std::memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+//! Loads 1 to 7 bytes as a little-endian number without a variable-size copy.
+[[nodiscard]] constexpr u64 load_tail(const u8 * const data, const size_t size) noexcept
+{
+    if (size >= 4)
+    {
+        // Two overlapping 4-byte loads, the overlapping bytes are the same in both.
+        const auto low = load<u32>(data);
+        const auto high = load<u32>(data + size - 4);
+        return low | (static_cast<u64>(high) << (8 * (size - 4)));
+    }
+    return data[0] | (static_cast<u64>(data[size / 2]) << (8 * (size / 2))) |
+           (static_cast<u64>(data[size - 1]) << (8 * (size - 1)));
+}
+
+//! Accumulator lanes of StripeHasher, one per 8 bytes of a stripe.
+constexpr size_t stripe_lanes = 8;
+constexpr size_t stripe_size = stripe_lanes * sizeof(u64);
+
+//! Keys of the unseeded StripeHasher.
+constexpr u64 stripe_keys[stripe_lanes] = {
+    secret0,
+    secret1,
+    secret2,
+    secret3,
+    0x9e3779b185ebca87,
+    0xc2b2ae3d27d4eb4f,
+    0x165667b19e3779f9,
+    0x85ebca77c2b2ae63,
+};
+
+constexpr void accumulate_stripes_scalar(
+    u64 * const acc,
+    const u64 * const keys,
+    const u8 * data,
+    const size_t stripes) noexcept
+{
+    u64 a[stripe_lanes];
+    std::copy_n(acc, stripe_lanes, a);
+    for (size_t i = 0; i < stripes; ++i, data += stripe_size)
+    {
+        // Fixed trip count, the compiler unrolls it.
+        for (size_t j = 0; j < stripe_lanes; ++j)
+        {
+            const auto d = load<u64>(data + j * sizeof(u64));
+            const auto keyed = d ^ keys[j];
+            a[j ^ 1] += d;
+            a[j] += (keyed & 0xffffffff) * (keyed >> 32);
+        }
+    }
+    std::copy_n(a, stripe_lanes, acc);
+}
+
+//! Adds stripes of data to the accumulators: acc[i] += low(d ^ k) * high(d ^ k) and acc[i ^ 1] += d for every
+//! 64-bit word d of a stripe. The multiplications are 32x32 bits, so every vector instruction set has them.
+constexpr void accumulate_stripes(
+    u64 * const acc,
+    const u64 * const keys,
+    const u8 * data,
+    const size_t stripes) noexcept
+{
+    if (std::is_constant_evaluated())
+    {
+        accumulate_stripes_scalar(acc, keys, data, stripes);
+        return;
+    }
+#if defined(__AVX2__)
+    auto * const acc_vectors = reinterpret_cast<__m256i *>(acc);
+    __m256i a0 = _mm256_loadu_si256(acc_vectors);
+    __m256i a1 = _mm256_loadu_si256(acc_vectors + 1);
+    const __m256i k0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys));
+    const __m256i k1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys) + 1);
+    const auto step = [](__m256i & a, const __m256i d, const __m256i k)
+    {
+        const __m256i keyed = _mm256_xor_si256(d, k);
+        const __m256i product = _mm256_mul_epu32(keyed, _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+        a = _mm256_add_epi64(a, _mm256_add_epi64(product, _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2))));
+    };
+    for (size_t i = 0; i < stripes; ++i, data += stripe_size)
+    {
+        step(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data)), k0);
+        step(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data) + 1), k1);
+    }
+    _mm256_storeu_si256(acc_vectors, a0);
+    _mm256_storeu_si256(acc_vectors + 1, a1);
+#elif defined(__SSE2__) || defined(_M_X64)
+    auto * const acc_vectors = reinterpret_cast<__m128i *>(acc);
+    const auto * const key_vectors = reinterpret_cast<const __m128i *>(keys);
+    __m128i a[4];
+    __m128i k[4];
+    for (size_t j = 0; j < 4; ++j)
+    {
+        a[j] = _mm_loadu_si128(acc_vectors + j);
+        k[j] = _mm_loadu_si128(key_vectors + j);
+    }
+    for (size_t i = 0; i < stripes; ++i, data += stripe_size)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data) + j);
+            const __m128i keyed = _mm_xor_si128(d, k[j]);
+            const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            a[j] = _mm_add_epi64(a[j], _mm_add_epi64(product, _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+    }
+    for (size_t j = 0; j < 4; ++j)
+    {
+        _mm_storeu_si128(acc_vectors + j, a[j]);
+    }
+#elif defined(__ARM_NEON)
+    uint64x2_t a[4];
+    uint64x2_t k[4];
+    for (size_t j = 0; j < 4; ++j)
+    {
+        a[j] = vld1q_u64(acc + 2 * j);
+        k[j] = vld1q_u64(keys + 2 * j);
+    }
+    for (size_t i = 0; i < stripes; ++i, data += stripe_size)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            const uint64x2_t d = vreinterpretq_u64_u8(vld1q_u8(data + 16 * j));
+            const uint64x2_t keyed = veorq_u64(d, k[j]);
+            const uint64x2_t product = vmull_u32(vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+            a[j] = vaddq_u64(a[j], vaddq_u64(product, vextq_u64(d, d, 1)));
+        }
+    }
+    for (size_t j = 0; j < 4; ++j)
+    {
+        vst1q_u64(acc + 2 * j, a[j]);
+    }
+#else
+    accumulate_stripes_scalar(acc, keys, data, stripes);
+#endif
+}
+
+//! Spreads the high bits of the accumulators, the additions only carry upwards.
+constexpr void scramble_stripes(u64 * const acc, const u64 * const keys) noexcept
+{
+    for (size_t j = 0; j < stripe_lanes; ++j)
+    {
+        acc[j] = (acc[j] ^ (acc[j] >> 47) ^ keys[j]) * 0x9e3779b1;
+    }
+}
+
+} // namespace __hash_detail
 
 //! Fowler-Noll-Vo 1a 64-bit.
-class Hasher final
+//! Hashes a byte at a time, prefer MixHasher or WyHasher unless the digests must stay the same.
+class Fnv1aHasher final
 {
 public:
-    Hasher() noexcept = default;
+    Fnv1aHasher() noexcept = default;
+
+    //! FNV-1a has collisions which don't depend on the seed, use MixHasher or WyHasher against crafted keys.
+    explicit constexpr Fnv1aHasher(const u64 seed) noexcept
+        : hash_(fnv_offset_basis ^ seed)
+    {
+    }
 
-    void update(const u8 * const data, const size_t size) noexcept
+    constexpr void update(const u8 * const data, const size_t size) noexcept
     {
         for (size_t i = 0; i < size; ++i)
         {
@@ -34,13 +279,13 @@ public:
         }
     }
 
-    template <Hashable T>
-    void update(const T & value) noexcept
+    template <Hashable<Fnv1aHasher> T>
+    constexpr void update(const T & value) noexcept
     {
         HashImpl<T>::update(*this, value);
     }
 
-    [[nodiscard]] u64 digest() const noexcept
+    [[nodiscard]] constexpr u64 digest() const noexcept
     {
         return hash_;
     }
@@ -53,28 +298,403 @@ private:
     u64 hash_ = fnv_offset_basis;
 };
 
+//! Mixes a 64-bit word at a time into the state with a folded 128-bit multiplication.
+//! Suits short keys: integers and short strings take a multiplication per word and one to finish.
+class MixHasher final
+{
+public:
+    MixHasher() noexcept = default;
+
+    explicit constexpr MixHasher(const u64 seed) noexcept
+        : state_(__hash_detail::secret0 ^ seed)
+    {
+    }
+
+    constexpr void update(const u8 * data, size_t size) noexcept
+    {
+        using namespace __hash_detail;
+        for (; size >= sizeof(u64); data += sizeof(u64), size -= sizeof(u64))
+        {
+            state_ = multiply_fold(load<u64>(data) ^ secret1, state_ ^ secret2);
+        }
+        if (size != 0)
+        {
+            state_ = multiply_fold(load_tail(data, size) ^ secret2, state_ ^ secret3 ^ size);
+        }
+    }
+
+    template <Hashable<MixHasher> T>
+    constexpr void update(const T & value) noexcept
+    {
+        HashImpl<T>::update(*this, value);
+    }
+
+    [[nodiscard]] constexpr u64 digest() const noexcept
+    {
+        return __hash_detail::multiply_fold(state_ ^ __hash_detail::secret1, __hash_detail::secret3);
+    }
+
+private:
+    u64 state_ = __hash_detail::secret0;
+};
+
+//! Streaming variant of wyhash: three independent lanes consume 48-byte blocks.
+//! Suits long buffers, short updates are collected in a block buffer first.
+class WyHasher final
+{
+public:
+    WyHasher() noexcept = default;
+
+    explicit constexpr WyHasher(const u64 seed) noexcept
+        : lanes_ { seeded_lane(seed), seeded_lane(seed), seeded_lane(seed) }
+    {
+    }
+
+    constexpr void update(const u8 * data, size_t size) noexcept
+    {
+        length_ += size;
+        if (buffered_ + size <= block_size)
+        {
+            append(data, size);
+            return;
+        }
+        // The last block is kept buffered, digest() finishes it differently.
+        if (buffered_ != 0)
+        {
+            const auto fill = block_size - buffered_;
+            append(data, fill);
+            data += fill;
+            size -= fill;
+            consume(buffer_);
+            buffered_ = 0;
+        }
+        for (; size > block_size; data += block_size, size -= block_size)
+        {
+            consume(data);
+        }
+        append(data, size);
+    }
+
+    template <Hashable<WyHasher> T>
+    constexpr void update(const T & value) noexcept
+    {
+        HashImpl<T>::update(*this, value);
+    }
+
+    [[nodiscard]] constexpr u64 digest() const noexcept
+    {
+        using namespace __hash_detail;
+        auto seed = lanes_[0];
+        if (length_ > block_size)
+        {
+            seed ^= lanes_[1] ^ lanes_[2];
+        }
+        const u8 * data = buffer_;
+        auto size = buffered_;
+        for (; size > 16; data += 16, size -= 16)
+        {
+            seed = multiply_fold(load<u64>(data) ^ secret1, load<u64>(data + 8) ^ seed);
+        }
+        u8 tail[16] = {};
+        __hash_detail::copy_bytes(tail, data, size);
+        const auto a = load<u64>(tail) ^ secret1;
+        const auto b = load<u64>(tail + 8) ^ seed;
+        const auto product = multiply_fold(a, b);
+        return multiply_fold(product ^ secret0 ^ length_, seed ^ secret1);
+    }
+
+private:
+    constexpr static size_t block_size = 48;
+    [[nodiscard]] constexpr static u64 seeded_lane(const u64 seed) noexcept
+    {
+        return seed ^ __hash_detail::multiply_fold(seed ^ __hash_detail::secret0, __hash_detail::secret1);
+    }
+
+private:
+    constexpr void append(const u8 * const data, const size_t size) noexcept
+    {
+        __hash_detail::copy_bytes(buffer_ + buffered_, data, size);
+        buffered_ += size;
+    }
+
+    constexpr void consume(const u8 * const block) noexcept
+    {
+        using namespace __hash_detail;
+        lanes_[0] = multiply_fold(load<u64>(block) ^ secret1, load<u64>(block + 8) ^ lanes_[0]);
+        lanes_[1] = multiply_fold(load<u64>(block + 16) ^ secret2, load<u64>(block + 24) ^ lanes_[1]);
+        lanes_[2] = multiply_fold(load<u64>(block + 32) ^ secret3, load<u64>(block + 40) ^ lanes_[2]);
+    }
+
+private:
+    u64 lanes_[3] = { seeded_lane(0), seeded_lane(0), seeded_lane(0) };
+    u64 length_ = 0;
+    size_t buffered_ = 0;
+    u8 buffer_[block_size];
+};
+
+//! XXH3-style hash of 64-byte stripes into eight accumulators, vectorized with AVX2, SSE2 or NEON when the target
+//! has them. Suits buffers of hundreds of bytes and more, every digest costs at least one full stripe.
+//! The instruction set is selected at compile time, all variants produce the same digests.
+class StripeHasher final
+{
+public:
+    constexpr StripeHasher() noexcept
+        : StripeHasher(0)
+    {
+    }
+
+    //! The seed is added to even keys and subtracted from odd ones.
+    explicit constexpr StripeHasher(const u64 seed) noexcept
+    {
+        for (size_t j = 0; j < __hash_detail::stripe_lanes; ++j)
+        {
+            keys_[j] = j % 2 == 0 ? __hash_detail::stripe_keys[j] + seed : __hash_detail::stripe_keys[j] - seed;
+        }
+        for (size_t j = 0; j < __hash_detail::stripe_lanes; ++j)
+        {
+            acc_[j] = keys_[j ^ 1];
+        }
+    }
+
+    constexpr void update(const u8 * data, size_t size) noexcept
+    {
+        using namespace __hash_detail;
+        length_ += size;
+        if (buffered_ + size <= stripe_size)
+        {
+            append(data, size);
+            return;
+        }
+        // The last stripe is kept buffered, digest() pads it.
+        if (buffered_ != 0)
+        {
+            const auto fill = stripe_size - buffered_;
+            append(data, fill);
+            data += fill;
+            size -= fill;
+            consume(buffer_, 1);
+            buffered_ = 0;
+        }
+        const auto stripes = (size - 1) / stripe_size;
+        consume(data, stripes);
+        data += stripes * stripe_size;
+        size -= stripes * stripe_size;
+        append(data, size);
+    }
+
+    template <Hashable<StripeHasher> T>
+    constexpr void update(const T & value) noexcept
+    {
+        HashImpl<T>::update(*this, value);
+    }
+
+    [[nodiscard]] constexpr u64 digest() const noexcept
+    {
+        using namespace __hash_detail;
+        u64 acc[stripe_lanes];
+        std::copy_n(acc_, stripe_lanes, acc);
+        if (buffered_ != 0)
+        {
+            u8 tail[stripe_size] = {};
+            copy_bytes(tail, buffer_, buffered_);
+            accumulate_stripes(acc, keys_, tail, 1);
+        }
+        auto result = length_ * 0x9e3779b185ebca87;
+        for (size_t j = 0; j < stripe_lanes; j += 2)
+        {
+            result += multiply_fold(acc[j] ^ keys_[j], acc[j + 1] ^ keys_[j + 1]);
+        }
+        result = (result ^ (result >> 37)) * 0x165667919e3779f9;
+        return result ^ (result >> 32);
+    }
+
+private:
+    //! Stripes between scrambles.
+    constexpr static size_t block_stripes = 16;
+
+private:
+    constexpr void append(const u8 * const data, const size_t size) noexcept
+    {
+        __hash_detail::copy_bytes(buffer_ + buffered_, data, size);
+        buffered_ += size;
+    }
+
+    constexpr void consume(const u8 * data, size_t stripes) noexcept
+    {
+        using namespace __hash_detail;
+        while (stripes != 0)
+        {
+            const auto count = std::min(stripes, block_stripes - block_position_);
+            accumulate_stripes(acc_, keys_, data, count);
+            data += count * stripe_size;
+            stripes -= count;
+            block_position_ += count;
+            if (block_position_ == block_stripes)
+            {
+                scramble_stripes(acc_, keys_);
+                block_position_ = 0;
+            }
+        }
+    }
+
+private:
+    u64 keys_[__hash_detail::stripe_lanes];
+    u64 acc_[__hash_detail::stripe_lanes];
+    u64 length_ = 0;
+    size_t buffered_ = 0;
+    size_t block_position_ = 0;
+    u8 buffer_[__hash_detail::stripe_size];
+};
+
+template <typename S>
+concept HashSeed = std::same_as<decltype(S::seed()), u64>;
+
+//! Seed known at compile time, digests are the same in every run.
+template <u64 Value = 0>
+struct FixedSeed final
+{
+    [[nodiscard]] constexpr static u64 seed() noexcept
+    {
+        return Value;
+    }
+};
+
+//! Seed chosen randomly once per process. Tables keyed by untrusted input should use it with MixHasher or
+//! WyHasher, so collisions can't be prepared in advance.
+struct RandomSeed final
+{
+    [[nodiscard]] static u64 seed() noexcept
+    {
+        static const u64 seed = __hash_detail::generate_seed();
+        return seed;
+    }
+};
+
+//! H is one of the hashers: Fnv1aHasher, MixHasher, WyHasher or StripeHasher.
+template <typename H = Hasher, HashSeed Seed = FixedSeed<>>
 struct Hash final
 {
-    [[nodiscard]] u64 operator()(const Hashable auto & value) const noexcept
+    template <Hashable<H> T>
+    [[nodiscard]] constexpr u64 operator()(const T & value) const noexcept
     {
-        Hasher hasher;
+        H hasher(Seed::seed());
         hasher.update(value);
         return hasher.digest();
     }
 };
 
+//! Mixes a digest into another one, hash_combine(a, b) != hash_combine(b, a).
+[[nodiscard]] constexpr u64 hash_combine(const u64 seed, const u64 digest) noexcept
+{
+    return __hash_detail::multiply_fold(seed ^ __hash_detail::secret0, digest ^ __hash_detail::secret1);
+}
+
 template <typename T>
 struct HashImpl final
 {
-    static void update(Hasher & hasher, const T & value) noexcept;
+    template <typename H>
+    static void update(H & hasher, const T & value) noexcept;
 };
 
+namespace __hash_detail
+{
+
+//! Elements with unique object representations are hashed as bytes, their byte sequence determines the value.
+template <typename T, typename H>
+concept HashableAsBytes = std::has_unique_object_representations_v<T> && !HashableByMethod<T, H>;
+
+template <typename T>
+concept HashableByAnyMethod = HashableByMethod<T, Fnv1aHasher> || HashableByMethod<T, MixHasher> ||
+                              HashableByMethod<T, WyHasher> || HashableByMethod<T, StripeHasher>;
+
+template <typename T>
+concept StringLike = std::convertible_to<const T &, std::string_view>;
+
+template <typename T>
+concept SizePrefixed = StringLike<T> || (std::ranges::sized_range<T> && !HashableByAnyMethod<T>);
+
+} // namespace __hash_detail
+
+//! Hashes a part of a composite value. Strings and ranges are preceded by their size, so that ("ab", "c") and
+//! ("a", "bc") or {{1}, {2, 3}} and {{1, 2}, {3}} give different digests.
+template <typename H, typename T>
+    requires Hashable<T, H>
+constexpr void update_element(H & hasher, const T & value) noexcept
+{
+    if constexpr (__hash_detail::StringLike<T>)
+    {
+        hasher.update(static_cast<u64>(std::string_view(value).size()));
+    }
+    else if constexpr (__hash_detail::SizePrefixed<T>)
+    {
+        hasher.update(static_cast<u64>(std::ranges::size(value)));
+    }
+    hasher.update(value);
+}
+
+namespace __hash_detail
+{
+
+//! Hashes an array with a single update(data, size) when its elements are hashable as bytes.
+template <typename H, typename T>
+constexpr void update_contiguous(H & hasher, const T * const data, const size_t size) noexcept
+{
+    if constexpr (HashableAsBytes<T, H>)
+    {
+        if (std::is_constant_evaluated())
+        {
+            // Chunks are a multiple of 8 bytes, word-at-a-time hashers see the same words as with one update.
+            u8 chunk[64];
+            size_t used = 0;
+            for (size_t i = 0; i < size; ++i)
+            {
+                for (const auto byte : std::bit_cast<std::array<u8, sizeof(T)>>(data[i]))
+                {
+                    chunk[used++] = byte;
+                    if (used == sizeof(chunk))
+                    {
+                        hasher.update(chunk, used);
+                        used = 0;
+                    }
+                }
+            }
+            hasher.update(chunk, used);
+        }
+        else
+        {
+            hasher.update(reinterpret_cast<const u8 *>(data), size * sizeof(T));
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            update_element(hasher, data[i]);
+        }
+    }
+}
+
+} // namespace __hash_detail
+
 template <>
 struct HashImpl<std::string_view> final
 {
-    static void update(Hasher & hasher, const std::string_view value) noexcept
+    template <typename H>
+    constexpr static void update(H & hasher, const std::string_view value) noexcept
     {
-        hasher.update(reinterpret_cast<const u8 *>(value.data()), value.size());
+        __hash_detail::update_contiguous(hasher, value.data(), value.size());
+    }
+};
+
+//! Strings are hashed as string_view: Hash {}(std::string("a")) == Hash {}(std::string_view("a")).
+template <typename T>
+    requires __hash_detail::StringLike<T> && (!std::same_as<T, std::string_view>)
+struct HashImpl<T> final
+{
+    template <typename H>
+    constexpr static void update(H & hasher, const T & value) noexcept
+    {
+        HashImpl<std::string_view>::update(hasher, std::string_view(value));
     }
 };
 
@@ -82,52 +702,197 @@ template <typename T>
     requires std::is_arithmetic_v<T> || std::is_enum_v<T>
 struct HashImpl<T> final
 {
-    static void update(Hasher & hasher, const T & value) noexcept
+    template <typename H>
+    constexpr static void update(H & hasher, const T & value) noexcept
     {
-        hasher.update(reinterpret_cast<const u8 *>(&value), sizeof(T));
+        if (std::is_constant_evaluated())
+        {
+            const auto bytes = std::bit_cast<std::array<u8, sizeof(T)>>(value);
+            hasher.update(bytes.data(), bytes.size());
+        }
+        else
+        {
+            hasher.update(reinterpret_cast<const u8 *>(&value), sizeof(T));
+        }
     }
 };
 
-template <HashableByMethod T>
+template <__hash_detail::HashableByAnyMethod T>
 struct HashImpl<T> final
 {
-    static void update(Hasher & hasher, const T & value) noexcept
+    template <typename H>
+        requires HashableByMethod<T, H>
+    constexpr static void update(H & hasher, const T & value) noexcept
     {
         value.hash(hasher);
     }
 };
 
+//! Arrays, vectors, spans and other contiguous ranges.
+template <std::ranges::contiguous_range R>
+    requires(!__hash_detail::StringLike<R> && !__hash_detail::HashableByAnyMethod<R>)
+struct HashImpl<R> final
+{
+    template <typename H>
+        requires Hashable<std::ranges::range_value_t<R>, H>
+    constexpr static void update(H & hasher, const R & range) noexcept
+    {
+        const auto size = static_cast<size_t>(std::ranges::size(range));
+        __hash_detail::update_contiguous(hasher, std::ranges::data(range), size);
+    }
+};
+
+template <typename A, typename B>
+struct HashImpl<std::pair<A, B>> final
+{
+    template <typename H>
+        requires Hashable<A, H> && Hashable<B, H>
+    constexpr static void update(H & hasher, const std::pair<A, B> & value) noexcept
+    {
+        update_element(hasher, value.first);
+        update_element(hasher, value.second);
+    }
+};
+
+template <typename... Ts>
+struct HashImpl<std::tuple<Ts...>> final
+{
+    template <typename H>
+        requires(Hashable<Ts, H> && ...)
+    constexpr static void update(H & hasher, const std::tuple<Ts...> & value) noexcept
+    {
+        std::apply([&hasher](const Ts &... elements) { (update_element(hasher, elements), ...); }, value);
+    }
+};
+
+//! An empty optional is hashed as false, an engaged one as true followed by the value.
+template <typename T>
+struct HashImpl<std::optional<T>> final
+{
+    template <typename H>
+        requires Hashable<T, H>
+    constexpr static void update(H & hasher, const std::optional<T> & value) noexcept
+    {
+        hasher.update(value.has_value());
+        if (value.has_value())
+        {
+            update_element(hasher, *value);
+        }
+    }
+};
+
+//! Number of keys hash_batch hashes side by side.
+constexpr size_t hash_batch_lanes = 8;
+
+namespace __hash_detail
+{
+
+//! Hashes hash_batch_lanes keys by independent hashers.
+template <typename H, typename Seed, typename T>
+void hash_group(const T * const keys, u64 * const digests) noexcept
+{
+    for (size_t lane = 0; lane < hash_batch_lanes; ++lane)
+    {
+        H hasher(Seed::seed());
+        hasher.update(keys[lane]);
+        digests[lane] = hasher.digest();
+    }
+}
+
+} // namespace __hash_detail
+
+//! Writes Hash<H, Seed> {}(keys[i]) to digests[i].
+//! Keys are hashed in groups of hash_batch_lanes by independent hashers without work in between, so the
+//! multiplication chains of a group overlap. Hash keys with it before probing a table rather than one at a time
+//! between probes.
+template <typename H = Hasher, HashSeed Seed = FixedSeed<>, std::ranges::contiguous_range Keys>
+    requires Hashable<std::ranges::range_value_t<Keys>, H>
+void hash_batch(const Keys & keys, const std::span<u64> digests) noexcept
+{
+    const auto size = static_cast<size_t>(std::ranges::size(keys));
+    AR_PRE(digests.size() >= size);
+    const auto * const data = std::ranges::data(keys);
+    auto * const out = digests.data();
+    size_t i = 0;
+    for (; i + hash_batch_lanes <= size; i += hash_batch_lanes)
+    {
+        __hash_detail::hash_group<H, Seed>(data + i, out + i);
+    }
+    for (; i < size; ++i)
+    {
+        out[i] = Hash<H, Seed> {}(data[i]);
+    }
+}
+
+//! hash_batch for keys and digests in AlignedBuffers. The last group runs into the padding if both buffers have
+//! room for it, so there is no scalar tail. Padding keys are hashed into the padding of digests.
+template <typename H = Hasher, HashSeed Seed = FixedSeed<>, typename Key, size_t KeyAlignment, size_t Alignment>
+    requires Hashable<Key, H>
+void hash_batch(const AlignedBuffer<Key, KeyAlignment> & keys, AlignedBuffer<u64, Alignment> & digests) noexcept
+{
+    const auto size = keys.size();
+    AR_PRE(digests.size() >= size);
+    const auto padded = std::min(keys.padded_size(), digests.padded_size());
+    const auto * const data = keys.data();
+    auto * const out = digests.data();
+    size_t i = 0;
+    for (; i < size && i + hash_batch_lanes <= padded; i += hash_batch_lanes)
+    {
+        __hash_detail::hash_group<H, Seed>(data + i, out + i);
+    }
+    for (; i < size; ++i)
+    {
+        out[i] = Hash<H, Seed> {}(data[i]);
+    }
+}
+
+template <typename H = Hasher, HashSeed Seed = FixedSeed<>>
 struct StrHash final
 {
     using is_transparent = void;
 
-    [[nodiscard]] u64 operator()(const std::string_view value) const noexcept
+    [[nodiscard]] constexpr u64 operator()(const std::string_view value) const noexcept
     {
-        return Hash {}(value);
+        return Hash<H, Seed> {}(value);
     }
 
-    [[nodiscard]] u64 operator()(const std::string & value) const noexcept
+    [[nodiscard]] constexpr u64 operator()(const std::string & value) const noexcept
     {
-        return Hash {}(std::string_view(value));
+        return Hash<H, Seed> {}(std::string_view(value));
     }
 
-    [[nodiscard]] u64 operator()(const char * const value) const noexcept
+    [[nodiscard]] constexpr u64 operator()(const char * const value) const noexcept
     {
-        return Hash {}(std::string_view(value));
+        return Hash<H, Seed> {}(std::string_view(value));
     }
 };
 
+inline namespace literals
+{
+inline namespace hash_literals
+{
+
+//! Hash {} of the string computed at compile time, e.g. for case labels of a switch on Hash {}(name).
+[[nodiscard]] consteval u64 operator""_hash(const char * const data, const size_t size) noexcept
+{
+    return Hash<> {}(std::string_view(data, size));
+}
+
+} // namespace hash_literals
+} // namespace literals
+
 template <typename T>
-concept HashableStr = requires(T && value) { StrHash {}(std::forward<T>(value)); };
+concept HashableStr = requires(T && value) { StrHash<> {}(std::forward<T>(value)); };
 
 struct StrEq final
 {
     using is_transparent = void;
 
+    //! Compares contents, also of two C strings.
     template <HashableStr A, HashableStr B>
-    [[nodiscard]] constexpr auto operator()(A && a, B && b) noexcept(noexcept(std::forward<A>(a) == std::forward<B>(b)))
+    [[nodiscard]] constexpr bool operator()(const A & a, const B & b) const noexcept
     {
-        return std::forward<A>(a) == std::forward<B>(b);
+        return std::string_view(a) == std::string_view(b);
     }
 };
 
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <source_location>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+#include <ka/common/fixed.hpp>
+#include <ka/common/log.hpp>
+
+//! KA_SCOPED_TIMER and KA_COUNTER expand to nothing if this is 0, see the KA_INSTRUMENTATION option.
+#ifndef KA_INSTRUMENTATION
+    #define KA_INSTRUMENTATION 1
+#endif
+
+namespace ka
+{
+
+//! Reads a cheap monotonic tick counter: the TSC on x86, the virtual counter on AArch64, steady_clock elsewhere.
+//! The tick rate is unspecified, instrument_stats and the log backend convert ticks to nanoseconds.
+[[nodiscard]] inline u64 read_ticks() noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    u64 ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<u64>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+enum class InstrumentKind : u8
+{
+    timer,
+    counter,
+};
+
+namespace __instrument_detail
+{
+
+//! Static part of a KA_SCOPED_TIMER or KA_COUNTER, one per call site. Sites are registered on construction and
+//! numbered in the order of registration.
+class InstrumentSite final
+{
+public:
+    InstrumentSite(InstrumentKind kind, std::string_view name, const std::source_location & location);
+
+    InstrumentSite(const InstrumentSite &) = delete;
+    InstrumentSite & operator=(const InstrumentSite &) = delete;
+
+    [[nodiscard]] u32 id() const noexcept
+    {
+        return id_;
+    }
+
+    [[nodiscard]] InstrumentKind kind() const noexcept
+    {
+        return kind_;
+    }
+
+    [[nodiscard]] std::string_view name() const noexcept
+    {
+        return name_;
+    }
+
+    [[nodiscard]] const std::source_location & location() const noexcept
+    {
+        return location_;
+    }
+
+private:
+    std::string_view name_;
+    std::source_location location_;
+    u32 id_;
+    InstrumentKind kind_;
+};
+
+//! Measurements of one site by one thread. Only the owning thread writes them, so updates are plain loads and
+//! stores, the atomics only keep concurrent readers from seeing torn values.
+struct InstrumentSlot final
+{
+    std::atomic<u64> count;
+    std::atomic<u64> ticks;
+    std::atomic<u64> max_ticks;
+};
+
+constexpr std::size_t slot_chunk_bits = 6;
+constexpr std::size_t slot_chunk_size = std::size_t { 1 } << slot_chunk_bits;
+constexpr std::size_t max_slot_chunks = 1024;
+//! Maximum number of sites, registering more terminates the program.
+constexpr std::size_t max_sites = slot_chunk_size * max_slot_chunks;
+
+//! Chunks are aligned to cache lines, slots of different threads never share one.
+struct alignas(cache_line_size) InstrumentSlotChunk final
+{
+    std::array<InstrumentSlot, slot_chunk_size> slots {};
+};
+
+//! Slots of one thread, allocated when it first reaches a site. Chunks are never moved or freed, the slots of
+//! a thread which has exited keep counting for the next thread to take them over.
+struct ThreadSlots final
+{
+    std::array<std::atomic<InstrumentSlotChunk *>, max_slot_chunks> chunks {};
+    ThreadSlots * next = nullptr;
+    std::atomic<bool> owned = true;
+};
+
+extern constinit thread_local ThreadSlots * thread_slots;
+
+//! Allocates the slots of the calling thread or the chunk of the site.
+[[nodiscard]] InstrumentSlot & allocate_slot(u32 id);
+
+[[nodiscard]] inline InstrumentSlot & slot(const u32 id)
+{
+    if (auto * const slots = thread_slots; slots != nullptr) [[likely]]
+    {
+        if (auto * const chunk = slots->chunks[id >> slot_chunk_bits].load(std::memory_order_relaxed)) [[likely]]
+        {
+            return chunk->slots[id & (slot_chunk_size - 1)];
+        }
+    }
+    return allocate_slot(id);
+}
+
+inline void add(std::atomic<u64> & value, const u64 delta) noexcept
+{
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+inline void add_count(const InstrumentSite & site, const u64 value)
+{
+    add(slot(site.id()).count, value);
+}
+
+inline void add_time(const InstrumentSite & site, const u64 ticks)
+{
+    auto & target = slot(site.id());
+    add(target.count, 1);
+    add(target.ticks, ticks);
+    if (ticks > target.max_ticks.load(std::memory_order_relaxed))
+    {
+        target.max_ticks.store(ticks, std::memory_order_relaxed);
+    }
+}
+
+//! Measures the ticks from its construction to its destruction.
+class ScopedTimer final
+{
+public:
+    explicit ScopedTimer(const InstrumentSite & site) noexcept
+        : site_(site)
+        , start_(read_ticks())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        add_time(site_, read_ticks() - start_);
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+private:
+    const InstrumentSite & site_;
+    u64 start_;
+};
+
+} // namespace __instrument_detail
+
+//! Measurements of a site summed over all threads, including threads which have exited.
+//! Counters only have a count, it is the sum of the added values.
+struct InstrumentStats final
+{
+    std::string_view name;
+    std::source_location location;
+    InstrumentKind kind;
+    u64 count;
+    u64 total_nanoseconds;
+    u64 max_nanoseconds;
+};
+
+//! Sums the measurements of every site reached so far, in the order the sites were first reached. A thread's latest
+//! updates may be missing, measurements of a thread are never torn.
+[[nodiscard]] std::vector<InstrumentStats> instrument_stats();
+
+//! Logs a record per site at the location of the site.
+void log_instrument_stats(LogLevel level = LogLevel::info);
+
+//! Logs the stats every period from a background thread, a zero period stops it.
+void report_instrument_stats(std::chrono::milliseconds period, LogLevel level = LogLevel::info);
+
+} // namespace ka
+
+#define _KA_INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define _KA_INSTRUMENT_CONCAT(a, b) _KA_INSTRUMENT_CONCAT_IMPL(a, b)
+
+#if KA_INSTRUMENTATION
+    //! Measures the rest of the enclosing scope, e.g. KA_SCOPED_TIMER("parse"). Costs two tick reads and a few
+    //! loads and stores into a slot of the calling thread.
+    #define KA_SCOPED_TIMER(name)                                                                                      \
+        static const ::ka::__instrument_detail::InstrumentSite _KA_INSTRUMENT_CONCAT(_ka_timer_site_, __LINE__) {      \
+            ::ka::InstrumentKind::timer,                                                                               \
+            name,                                                                                                      \
+            std::source_location::current()                                                                            \
+        };                                                                                                             \
+        const ::ka::__instrument_detail::ScopedTimer _KA_INSTRUMENT_CONCAT(_ka_timer_, __LINE__)(                      \
+            _KA_INSTRUMENT_CONCAT(_ka_timer_site_, __LINE__))
+
+    //! Adds value to the counter of the call site.
+    #define KA_COUNTER_ADD(name, value)                                                                                \
+        do                                                                                                             \
+        {                                                                                                              \
+            static const ::ka::__instrument_detail::InstrumentSite _ka_counter_site {                                  \
+                ::ka::InstrumentKind::counter,                                                                         \
+                name,                                                                                                  \
+                std::source_location::current()                                                                        \
+            };                                                                                                         \
+            ::ka::__instrument_detail::add_count(_ka_counter_site, static_cast<::ka::u64>(value));                     \
+        } while (false)
+#else
+    #define KA_SCOPED_TIMER(name) static_assert(sizeof(name) != 0)
+    // The value is not evaluated.
+    #define KA_COUNTER_ADD(name, value) ((void)sizeof(name), (void)sizeof(value))
+#endif
+
+//! Counts how many times the call site is reached, e.g. KA_COUNTER("cache miss").
+#define KA_COUNTER(name) KA_COUNTER_ADD(name, 1)
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+#include <ka/common/assert.hpp>
+#include <ka/common/fixed.hpp>
+#include <ka/common/flat_hash.hpp>
+#include <ka/common/hash.hpp>
+
+namespace ka
+{
+
+//! Handle of a string interned by a StringPool. Strings interned by one pool are equal iff their handles are.
+class InternedStr final
+{
+public:
+    //! The invalid handle, it is not returned by any pool.
+    constexpr InternedStr() noexcept = default;
+
+    constexpr explicit InternedStr(const u32 value) noexcept
+        : value_(value)
+    {
+    }
+
+    [[nodiscard]] constexpr u32 value() const noexcept
+    {
+        return value_;
+    }
+
+    [[nodiscard]] constexpr bool valid() const noexcept
+    {
+        return value_ != invalid;
+    }
+
+    template <typename H>
+    constexpr void hash(H & hasher) const noexcept
+    {
+        hasher.update(value_);
+    }
+
+    [[nodiscard]] friend constexpr bool operator==(InternedStr, InternedStr) noexcept = default;
+
+private:
+    constexpr static u32 invalid = ~u32 { 0 };
+
+    u32 value_ = invalid;
+};
+
+//! Deduplicates strings and keeps them until the pool is destroyed.
+//! Every entry stores the StrHash<> digest of its string, so the digest of an interned string is not recomputed.
+//! All methods are thread-safe. The pool is split into shards locked separately, lookups of interned strings
+//! only take a shared lock, and resolving a handle takes no lock at all.
+class StringPool final
+{
+public:
+    constexpr static size_t shard_bits = 4;
+    constexpr static size_t shard_count = size_t { 1 } << shard_bits;
+    //! Maximum number of strings in one shard.
+    constexpr static size_t max_shard_size = size_t { 1 } << (32 - shard_bits);
+
+    StringPool() = default;
+    ~StringPool();
+
+    StringPool(const StringPool &) = delete;
+    StringPool & operator=(const StringPool &) = delete;
+
+    //! Throws std::length_error if the shard of the string is full.
+    [[nodiscard]] InternedStr intern(std::string_view str);
+
+    //! Returns the handle of a string interned before, without interning it.
+    [[nodiscard]] std::optional<InternedStr> find(std::string_view str) const;
+
+    [[nodiscard]] std::string_view str(const InternedStr handle) const noexcept
+    {
+        const auto & entry = get(handle);
+        return { entry.data, entry.size };
+    }
+
+    //! The string is null-terminated.
+    [[nodiscard]] const char * c_str(const InternedStr handle) const noexcept
+    {
+        return get(handle).data;
+    }
+
+    //! Equals StrHash<> {}(str(handle)).
+    [[nodiscard]] u64 digest(const InternedStr handle) const noexcept
+    {
+        return get(handle).digest;
+    }
+
+    [[nodiscard]] size_t size() const;
+
+private:
+    struct Entry final
+    {
+        const char * data;
+        size_t size;
+        u64 digest;
+    };
+
+    struct Key final
+    {
+        std::string_view str;
+        u64 digest;
+    };
+
+    //! The digest is already well mixed, the tables use it as it is.
+    struct KeyHash final
+    {
+        [[nodiscard]] u64 operator()(const Key & key) const noexcept
+        {
+            return key.digest;
+        }
+    };
+
+    struct KeyEq final
+    {
+        [[nodiscard]] bool operator()(const Key & a, const Key & b) const noexcept
+        {
+            return a.digest == b.digest && a.str == b.str;
+        }
+    };
+
+    // Entries of a shard are stored in chunks, chunk k holding first_chunk_size << k entries. Chunks are never
+    // moved, so handles are resolved without locking while other threads add entries.
+    constexpr static size_t first_chunk_bits = 8;
+    constexpr static size_t first_chunk_size = size_t { 1 } << first_chunk_bits;
+    constexpr static size_t max_chunks = 32 - shard_bits - first_chunk_bits + 1;
+    constexpr static size_t arena_block_size = 64 * 1024;
+
+    struct alignas(cache_line_size) Shard final
+    {
+        mutable std::shared_mutex mutex;
+        FlatHashMap<Key, u32, KeyHash, KeyEq> index;
+        std::array<std::atomic<Entry *>, max_chunks> chunks {};
+        size_t size = 0;
+        // Strings are copied into blocks of arena_block_size, longer strings get a block of their own.
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char * free = nullptr;
+        size_t free_size = 0;
+    };
+
+    [[nodiscard]] const Entry & get(const InternedStr handle) const noexcept
+    {
+        AR_PRE(handle.valid());
+        const auto & shard = shards_[handle.value() & (shard_count - 1)];
+        const auto position = (handle.value() >> shard_bits) + first_chunk_size;
+        const auto chunk = static_cast<size_t>(std::bit_width(position)) - first_chunk_bits - 1;
+        const auto * const entries = shard.chunks[chunk].load(std::memory_order_acquire);
+        return entries[position - (first_chunk_size << chunk)];
+    }
+
+    [[nodiscard]] constexpr static size_t shard_index(const u64 digest) noexcept
+    {
+        return static_cast<size_t>(digest >> (64 - shard_bits));
+    }
+
+    //! Copies the string into the arena of the shard, the caller holds the exclusive lock.
+    [[nodiscard]] static InternedStr insert(Shard & shard, size_t index, const Key & key);
+
+private:
+    std::array<Shard, shard_count> shards_;
+};
+
+} // namespace ka
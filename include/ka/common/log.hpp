@@ -1,59 +1,567 @@
 #pragma once
 
-#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
 #include <source_location>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable : 4996)
+    #include <fmt/core.h>
+    #pragma warning(pop)
+#else
+    #include <fmt/core.h>
+#endif
+
+#include <ka/common/arena.hpp>
+#include <ka/common/fixed.hpp>
+
+//! Records below this level are removed at compile time: 0 is debug, 4 is fatal.
+#ifndef KA_LOG_MIN_LEVEL
+    #define KA_LOG_MIN_LEVEL 0
+#endif
+
+static_assert(KA_LOG_MIN_LEVEL >= 0 && KA_LOG_MIN_LEVEL <= 4, "KA_LOG_MIN_LEVEL must be in [0, 4]");
 
 namespace ka
 {
 
+enum class LogLevel : u8
+{
+    debug,
+    info,
+    warning,
+    error,
+    fatal,
+};
+
+constexpr LogLevel compile_time_log_level = static_cast<LogLevel>(KA_LOG_MIN_LEVEL);
+
+enum class LogMode : u8
+{
+    //! Records are queued and written in batches by a background thread.
+    asynchronous,
+    //! Records are written by the calling thread before the log function returns.
+    synchronous,
+};
+
+//! Format string checked at compile time against the argument types, together with the location of the call.
+template <typename... Args>
+struct LogFormat final
+{
+    template <typename S>
+        requires std::convertible_to<const S &, fmt::string_view>
+    consteval LogFormat(const S & format, const std::source_location & location = std::source_location::current())
+        : format(format)
+        , location(location)
+    {
+    }
+
+    fmt::format_string<Args...> format;
+    std::source_location location;
+};
+
 namespace __log_detail
 {
 
-[[nodiscard]] std::string format_message(
-    std::string_view type,
+extern std::atomic<LogLevel> runtime_log_level;
+//! Level of the records kept by the flight recorder, flight_recorder_off while it is disabled.
+extern std::atomic<LogLevel> flight_recorder_level;
+//! The lower of the two levels above, records below it are dropped by a single check.
+extern std::atomic<LogLevel> submit_log_level;
+
+constexpr LogLevel flight_recorder_off = static_cast<LogLevel>(0xff);
+
+//! Types of deferred arguments as they are stored in a record.
+enum class ArgType : u8
+{
+    boolean,
+    character,
+    signed_integer,
+    unsigned_integer,
+    float32,
+    float64,
+    pointer,
+    string,
+};
+
+template <typename T>
+concept Character = std::same_as<T, char> || std::same_as<T, wchar_t> || std::same_as<T, char8_t> ||
+                    std::same_as<T, char16_t> || std::same_as<T, char32_t>;
+
+//! Copies a value of type Stored into a record and reads it back.
+template <ArgType Type, typename Stored>
+struct ScalarArgCodec
+{
+    using Decoded = Stored;
+    constexpr static ArgType type = Type;
+
+    [[nodiscard]] static std::size_t size(const auto &) noexcept
+    {
+        return sizeof(Stored);
+    }
+
+    static std::byte * encode(std::byte * const out, const auto & value) noexcept
+    {
+        const auto stored = static_cast<Stored>(value);
+        std::memcpy(out, &stored, sizeof(Stored));
+        return out + sizeof(Stored);
+    }
+
+    [[nodiscard]] static Stored decode(const std::byte *& in) noexcept
+    {
+        Stored value;
+        std::memcpy(&value, in, sizeof(Stored));
+        in += sizeof(Stored);
+        return value;
+    }
+};
+
+//! Strings are stored as their length followed by the characters.
+struct StringArgCodec
+{
+    using Decoded = fmt::string_view;
+    constexpr static ArgType type = ArgType::string;
+
+    [[nodiscard]] static std::size_t size(const std::string_view value) noexcept
+    {
+        return sizeof(u32) + value.size();
+    }
+
+    static std::byte * encode(std::byte * const out, const std::string_view value) noexcept
+    {
+        const auto size = static_cast<u32>(value.size());
+        std::memcpy(out, &size, sizeof(size));
+        std::memcpy(out + sizeof(size), value.data(), size);
+        return out + sizeof(size) + size;
+    }
+
+    [[nodiscard]] static fmt::string_view decode(const std::byte *& in) noexcept
+    {
+        u32 size;
+        std::memcpy(&size, in, sizeof(size));
+        const auto * const data = reinterpret_cast<const char *>(in + sizeof(size));
+        in += sizeof(size) + size;
+        return { data, size };
+    }
+};
+
+//! Arguments with an ArgCodec are copied into the record and formatted later by the consumer.
+template <typename T>
+struct ArgCodec;
+
+template <>
+struct ArgCodec<bool> final : ScalarArgCodec<ArgType::boolean, bool>
+{
+};
+
+template <>
+struct ArgCodec<char> final : ScalarArgCodec<ArgType::character, char>
+{
+};
+
+template <std::signed_integral T>
+    requires(!Character<T> && sizeof(T) <= sizeof(s64))
+struct ArgCodec<T> final : ScalarArgCodec<ArgType::signed_integer, s64>
+{
+};
+
+template <std::unsigned_integral T>
+    requires(!Character<T> && !std::same_as<T, bool> && sizeof(T) <= sizeof(u64))
+struct ArgCodec<T> final : ScalarArgCodec<ArgType::unsigned_integer, u64>
+{
+};
+
+template <>
+struct ArgCodec<f32> final : ScalarArgCodec<ArgType::float32, f32>
+{
+};
+
+template <>
+struct ArgCodec<f64> final : ScalarArgCodec<ArgType::float64, f64>
+{
+};
+
+template <typename T>
+    requires std::same_as<std::remove_cv_t<T>, void>
+struct ArgCodec<T *> final : ScalarArgCodec<ArgType::pointer, const void *>
+{
+};
+
+template <>
+struct ArgCodec<std::nullptr_t> final : ScalarArgCodec<ArgType::pointer, const void *>
+{
+};
+
+template <>
+struct ArgCodec<std::string_view> final : StringArgCodec
+{
+};
+
+template <>
+struct ArgCodec<std::string> final : StringArgCodec
+{
+};
+
+template <>
+struct ArgCodec<const char *> final : StringArgCodec
+{
+};
+
+template <>
+struct ArgCodec<char *> final : StringArgCodec
+{
+};
+
+template <std::size_t N>
+struct ArgCodec<char[N]> final : StringArgCodec
+{
+};
+
+template <typename T>
+using ArgCodecFor = ArgCodec<std::remove_cvref_t<T>>;
+
+template <typename T>
+concept DeferredArg = requires { ArgCodecFor<T>::type; };
+
+//! Formats arguments stored in a record.
+using FormatFn = fmt::appender (*)(fmt::appender out, fmt::string_view format, const std::byte * args);
+
+//! Stored arguments start with their count and types, this keeps records readable without knowing the call site.
+template <DeferredArg... Args>
+[[nodiscard]] std::size_t args_size(const Args &... args) noexcept
+{
+    static_assert(sizeof...(Args) <= 255);
+    return 1 + sizeof...(Args) + (std::size_t { 0 } + ... + ArgCodecFor<Args>::size(args));
+}
+
+template <DeferredArg... Args>
+void encode_args(std::byte * out, const Args &... args) noexcept
+{
+    *out++ = static_cast<std::byte>(sizeof...(Args));
+    ((*out++ = static_cast<std::byte>(ArgCodecFor<Args>::type)), ...);
+    ((out = ArgCodecFor<Args>::encode(out, args)), ...);
+}
+
+template <DeferredArg... Args>
+fmt::appender format_args(const fmt::appender out, const fmt::string_view format, const std::byte * args)
+{
+    args += 1 + sizeof...(Args);
+    // Braced initialization decodes the arguments from left to right.
+    const std::tuple<typename ArgCodecFor<Args>::Decoded...> decoded { ArgCodecFor<Args>::decode(args)... };
+    return std::apply(
+        [&](const auto &... values) { return fmt::vformat_to(out, format, fmt::make_format_args(values...)); },
+        decoded);
+}
+
+struct PendingRecord final
+{
+    std::size_t position;
+    std::byte * args;
+};
+
+//! Reserves a record with space for args_size bytes of arguments, the record must be passed to commit_record.
+//! Suppressed is the number of records dropped at this call site since the previous one, see KA_LOG_EVERY_N.
+[[nodiscard]] PendingRecord begin_record(
+    LogLevel level,
     const std::source_location & location,
-    std::string_view message);
+    u32 suppressed,
+    fmt::string_view format,
+    FormatFn formatter,
+    std::size_t args_size);
+
+void commit_record(PendingRecord record);
+
+//! Starts a record in the flight recorder ring of the calling thread, the record must be passed to
+//! commit_flight_record. Returns the storage for args_size bytes of arguments, or nullptr if they don't fit into a
+//! slot of the ring, the record then keeps only the format string.
+[[nodiscard]] std::byte * begin_flight_record(
+    LogLevel level,
+    const std::source_location & location,
+    u32 suppressed,
+    fmt::string_view format,
+    FormatFn formatter,
+    std::size_t args_size);
+
+void commit_flight_record() noexcept;
+
+//! Messages with arguments which can't be stored are formatted eagerly into a stack buffer of this size first.
+constexpr std::size_t eager_message_capacity = 256;
+
+//! Passes the record to the backend if its level is enabled and to the flight recorder if the recorder keeps it.
+template <typename... Args>
+void submit_enabled(
+    const LogLevel level,
+    const std::source_location & location,
+    const u32 suppressed,
+    const fmt::format_string<Args...> format,
+    Args &&... args)
+{
+    if constexpr ((DeferredArg<Args> && ...))
+    {
+        const auto formatter = &format_args<std::remove_cvref_t<Args>...>;
+        const auto size = args_size(args...);
+        if (level >= flight_recorder_level.load(std::memory_order_relaxed))
+        {
+            if (auto * const out = begin_flight_record(level, location, suppressed, format, formatter, size))
+            {
+                encode_args(out, args...);
+            }
+            commit_flight_record();
+        }
+        if (level >= runtime_log_level.load(std::memory_order_relaxed))
+        {
+            const auto record = begin_record(level, location, suppressed, format, formatter, size);
+            encode_args(record.args, args...);
+            commit_record(record);
+        }
+    }
+    else
+    {
+        // Arguments of other types may refer to state which is gone by the time the consumer runs, so the message
+        // is formatted here: into a buffer on the stack, or into a block of the thread's pool if it doesn't fit.
+        // Formatting takes the arguments by reference, forwarding them twice never moves from them.
+        std::array<char, eager_message_capacity> buffer;
+        const auto result = fmt::format_to_n(buffer.data(), buffer.size(), format, std::forward<Args>(args)...);
+        if (result.size <= buffer.size()) [[likely]]
+        {
+            const std::string_view message(buffer.data(), result.size);
+            submit_enabled<const std::string_view &>(level, location, suppressed, "{}", message);
+            return;
+        }
+        const std::unique_ptr<char[], PoolDeleter> spill(static_cast<char *>(thread_pool().allocate(result.size)));
+        fmt::format_to_n(spill.get(), result.size, format, std::forward<Args>(args)...);
+        const std::string_view message(spill.get(), result.size);
+        submit_enabled<const std::string_view &>(level, location, suppressed, "{}", message);
+    }
+}
+
+//! Disabled levels cost a relaxed load and a branch, levels below compile_time_log_level cost nothing.
+//! Records dropped by the level filter still reach the flight recorder if it keeps their level.
+template <LogLevel Level, typename... Args>
+void submit(const std::source_location & location, const fmt::format_string<Args...> format, Args &&... args)
+{
+    if constexpr (Level >= compile_time_log_level)
+    {
+        if (Level >= submit_log_level.load(std::memory_order_relaxed))
+        {
+            submit_enabled(Level, location, 0, format, std::forward<Args>(args)...);
+        }
+    }
+}
+
+//! Lets through every n-th record of a call site.
+class EveryNSampler final
+{
+public:
+    //! Returns the number of records suppressed since the previous one if the record should be logged.
+    [[nodiscard]] std::optional<u32> sample(const u64 n) noexcept
+    {
+        const auto count = count_.fetch_add(1, std::memory_order_relaxed);
+        if (n > 1 && count % n != 0)
+        {
+            return std::nullopt;
+        }
+        return count == 0 ? 0 : static_cast<u32>(std::max<u64>(n, 1) - 1);
+    }
+
+private:
+    std::atomic<u64> count_ = 0;
+};
+
+//! Lets through at most max_per_second records of a call site in each second.
+//! Concurrent callers at a second boundary may let a few extra records through.
+class RateLimitSampler final
+{
+public:
+    //! Returns the number of records suppressed since the previous one if the record should be logged.
+    [[nodiscard]] std::optional<u32> sample(const u32 max_per_second) noexcept
+    {
+        const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+                             std::chrono::steady_clock::now().time_since_epoch())
+                             .count();
+        auto second = second_.load(std::memory_order_relaxed);
+        if (second != now && second_.compare_exchange_strong(second, now, std::memory_order_relaxed))
+        {
+            count_.store(0, std::memory_order_relaxed);
+        }
+        if (count_.fetch_add(1, std::memory_order_relaxed) < max_per_second)
+        {
+            return suppressed_.exchange(0, std::memory_order_relaxed);
+        }
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+private:
+    std::atomic<s64> second_ = 0;
+    std::atomic<u32> count_ = 0;
+    std::atomic<u32> suppressed_ = 0;
+};
+
+template <LogLevel Level, typename Sampler, typename... Args>
+void submit_sampled(
+    Sampler & sampler,
+    const auto limit,
+    const std::source_location & location,
+    const fmt::format_string<Args...> format,
+    Args &&... args)
+{
+    if constexpr (Level >= compile_time_log_level)
+    {
+        if (Level >= submit_log_level.load(std::memory_order_relaxed))
+        {
+            if (const auto suppressed = sampler.sample(limit))
+            {
+                submit_enabled(Level, location, *suppressed, format, std::forward<Args>(args)...);
+            }
+        }
+    }
+}
 
 } // namespace __log_detail
 
+//! Records below the level are dropped. Fatal records are never dropped, debug is used by default.
+void set_log_level(LogLevel level) noexcept;
+
+[[nodiscard]] LogLevel log_level() noexcept;
+
+//! Asynchronous mode is used by default.
+void set_log_mode(LogMode mode);
+
+//! Blocks until all records submitted by the calling thread are written.
+void log_flush();
+
+struct FlightRecorderOptions final
+{
+    //! Records kept per thread, rounded up to a power of two.
+    std::size_t records_per_thread = 256;
+    //! Records at this level and above are kept, also when set_log_level drops them.
+    LogLevel level = LogLevel::debug;
+    //! File descriptor the records are dumped to.
+    int fd = 2;
+    //! Dumps the records on SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT, then lets the previous handler run.
+    bool install_signal_handlers = true;
+};
+
+//! Keeps the latest records of every thread in memory, they are dumped when an assertion fails or the process gets
+//! a fatal signal. The records are written into a ring of the calling thread without locking, arguments are copied
+//! as for asynchronous records. Calling it again changes the level and the file descriptor, the sizes of existing
+//! rings stay the same.
+void enable_flight_recorder(const FlightRecorderOptions & options = {});
+
+//! Writes the kept records of all threads ordered by time with async-signal-safe writes. Records are formatted into
+//! a buffer allocated by enable_flight_recorder, so the dump is safe in signal handlers. Records written while the
+//! dump runs may be skipped. Does nothing if the recorder is disabled or another dump is running.
+void dump_flight_recorder() noexcept;
+
 inline void log_debug(
     const std::string_view message,
     const std::source_location & location = std::source_location::current())
 {
-    std::cerr << __log_detail::format_message("D", location, message) << std::endl;
+    __log_detail::submit<LogLevel::debug>(location, "{}", message);
+}
+
+template <typename... Args>
+void log_debug(const LogFormat<std::type_identity_t<Args>...> format, Args &&... args)
+{
+    __log_detail::submit<LogLevel::debug>(format.location, format.format, std::forward<Args>(args)...);
 }
 
 inline void log_info(
     const std::string_view message,
     const std::source_location & location = std::source_location::current())
 {
-    std::cerr << __log_detail::format_message("I", location, message) << std::endl;
+    __log_detail::submit<LogLevel::info>(location, "{}", message);
+}
+
+template <typename... Args>
+void log_info(const LogFormat<std::type_identity_t<Args>...> format, Args &&... args)
+{
+    __log_detail::submit<LogLevel::info>(format.location, format.format, std::forward<Args>(args)...);
 }
 
 inline void log_warning(
     const std::string_view message,
     const std::source_location & location = std::source_location::current())
 {
-    std::cerr << __log_detail::format_message("W", location, message) << std::endl;
+    __log_detail::submit<LogLevel::warning>(location, "{}", message);
+}
+
+template <typename... Args>
+void log_warning(const LogFormat<std::type_identity_t<Args>...> format, Args &&... args)
+{
+    __log_detail::submit<LogLevel::warning>(format.location, format.format, std::forward<Args>(args)...);
 }
 
 inline void log_error(
     const std::string_view message,
     const std::source_location & location = std::source_location::current())
 {
-    std::cerr << __log_detail::format_message("E", location, message) << std::endl;
+    __log_detail::submit<LogLevel::error>(location, "{}", message);
+}
+
+template <typename... Args>
+void log_error(const LogFormat<std::type_identity_t<Args>...> format, Args &&... args)
+{
+    __log_detail::submit<LogLevel::error>(format.location, format.format, std::forward<Args>(args)...);
 }
 
+//! Fatal records are always written synchronously.
 inline void log_fatal(
     const std::string_view message,
     const std::source_location & location = std::source_location::current())
 {
-    std::cerr << __log_detail::format_message("F", location, message) << std::endl;
+    __log_detail::submit<LogLevel::fatal>(location, "{}", message);
 }
 
+template <typename... Args>
+void log_fatal(const LogFormat<std::type_identity_t<Args>...> format, Args &&... args)
+{
+    __log_detail::submit<LogLevel::fatal>(format.location, format.format, std::forward<Args>(args)...);
+}
+
+//! Logs a fatal record of a failed check and dumps the flight recorder, see enable_flight_recorder.
 void log_assert(
     std::string_view assert_type,
     std::string_view condition,
     const std::source_location & location = std::source_location::current());
 
 } // namespace ka
+
+//! Logs every n-th record of the call site, e.g. KA_LOG_EVERY_N(ka::LogLevel::warning, 100, "Retry {}", id).
+//! A logged record tells how many were suppressed before it. Sampling costs an atomic increment.
+#define KA_LOG_EVERY_N(level, n, ...)                                                                                  \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        static ::ka::__log_detail::EveryNSampler _ka_log_sampler;                                                      \
+        ::ka::__log_detail::submit_sampled<level>(                                                                     \
+            _ka_log_sampler,                                                                                           \
+            static_cast<::ka::u64>(n),                                                                                 \
+            std::source_location::current(),                                                                           \
+            __VA_ARGS__);                                                                                              \
+    } while (false)
+
+//! Logs at most max_per_second records of the call site in each second, otherwise the same as KA_LOG_EVERY_N.
+#define KA_LOG_RATE_LIMITED(level, max_per_second, ...)                                                                \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        static ::ka::__log_detail::RateLimitSampler _ka_log_sampler;                                                   \
+        ::ka::__log_detail::submit_sampled<level>(                                                                     \
+            _ka_log_sampler,                                                                                           \
+            static_cast<::ka::u32>(max_per_second),                                                                    \
+            std::source_location::current(),                                                                           \
+            __VA_ARGS__);                                                                                              \
+    } while (false)
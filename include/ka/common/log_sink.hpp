@@ -0,0 +1,170 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <ka/common/fixed.hpp>
+
+namespace ka
+{
+
+enum class LogEncoding : u8
+{
+    //! One line per record, as written to stderr.
+    text,
+    //! Compact binary stream, ka_log_decode turns it back into text.
+    binary,
+};
+
+//! Destination of formatted log records.
+//! The logging backend calls a sink from one thread at a time.
+class LogSink
+{
+public:
+    virtual ~LogSink() = default;
+
+    //! Writes a batch of formatted records, one buffer per record.
+    virtual void write(std::span<const std::string_view> buffers) = 0;
+
+    [[nodiscard]] virtual LogEncoding encoding() const noexcept
+    {
+        return LogEncoding::text;
+    }
+
+    //! Called when the backend has no more records to write for now.
+    virtual void flush()
+    {
+    }
+};
+
+//! Collects records in a buffer which is written to a file descriptor when it is full or flushed.
+//! A batch which does not fit the buffer is written together with it in one gathering write.
+class FdLogSink : public LogSink
+{
+public:
+    constexpr static std::size_t default_buffer_size = 64 * 1024;
+
+    //! The descriptor is not closed by the sink.
+    explicit FdLogSink(int fd, std::size_t buffer_size = default_buffer_size);
+    ~FdLogSink() override;
+
+    void write(std::span<const std::string_view> buffers) override;
+    void flush() override;
+
+protected:
+    int fd_;
+
+private:
+    std::vector<char> buffer_;
+};
+
+//! Appends records to a file, creating it if necessary.
+class FileLogSink final : public FdLogSink
+{
+public:
+    constexpr static std::size_t default_buffer_size = 1024 * 1024;
+
+    //! Throws std::system_error if the file can't be opened.
+    explicit FileLogSink(const std::filesystem::path & path, std::size_t buffer_size = default_buffer_size);
+    ~FileLogSink() override;
+};
+
+//! Moves the file to `<path>.1` and starts a new one when the size or the age limit is exceeded.
+//! Files are split between records, a file exceeds max_size only if it holds a single record.
+//! Previously rotated files are shifted to `<path>.2` and so on, files past max_files are deleted.
+class RotatingFileLogSink final : public LogSink
+{
+public:
+    struct Options final
+    {
+        std::filesystem::path path;
+        //! Zero disables rotation by size.
+        std::size_t max_size = 64 * 1024 * 1024;
+        //! Zero disables rotation by age.
+        std::chrono::seconds max_age { 0 };
+        std::size_t max_files = 5;
+        std::size_t buffer_size = FileLogSink::default_buffer_size;
+    };
+
+    //! Throws std::system_error if the file can't be opened.
+    explicit RotatingFileLogSink(Options options);
+
+    void write(std::span<const std::string_view> buffers) override;
+    void flush() override;
+
+private:
+    void rotate();
+
+private:
+    Options options_;
+    std::unique_ptr<FileLogSink> file_;
+    std::size_t file_size_ = 0;
+    std::chrono::steady_clock::time_point opened_at_;
+};
+
+//! Passes the binary encoding of records to another sink.
+//! Each buffer holds one record preceded by the definitions it depends on, so sinks splitting a batch between
+//! buffers never separate a record from its call site. Files rotated this way are decoded in order.
+class BinaryLogSink final : public LogSink
+{
+public:
+    explicit BinaryLogSink(std::shared_ptr<LogSink> sink) noexcept;
+
+    void write(std::span<const std::string_view> buffers) override;
+    void flush() override;
+
+    [[nodiscard]] LogEncoding encoding() const noexcept override;
+
+private:
+    std::shared_ptr<LogSink> sink_;
+};
+
+#ifndef _WIN32
+
+//! Keeps the last `capacity` bytes of records in a memory-mapped file used as a ring buffer.
+//! Writing is a memory copy, the kernel writes the pages back even if the process crashes.
+//! The file starts with a MappedRingHeader, the data follows it. An existing ring of the same capacity is
+//! continued rather than overwritten.
+class MappedRingLogSink final : public LogSink
+{
+public:
+    struct MappedRingHeader final
+    {
+        char magic[8];
+        u64 capacity;
+        //! Total number of bytes ever written, the ring holds the last `capacity` of them.
+        u64 position;
+    };
+
+    constexpr static char magic[8] = { 'K', 'A', 'L', 'O', 'G', 'R', 'N', 'G' };
+
+    //! Throws std::system_error if the file can't be created or mapped.
+    MappedRingLogSink(const std::filesystem::path & path, std::size_t capacity);
+    ~MappedRingLogSink() override;
+
+    MappedRingLogSink(const MappedRingLogSink &) = delete;
+    MappedRingLogSink & operator=(const MappedRingLogSink &) = delete;
+
+    void write(std::span<const std::string_view> buffers) override;
+
+private:
+    std::byte * mapping_ = nullptr;
+    std::size_t mapping_size_ = 0;
+    MappedRingHeader * header_ = nullptr;
+    std::byte * data_ = nullptr;
+};
+
+#endif
+
+//! Replaces the sinks records are written to, records submitted before the call go to the old sinks.
+//! By default records are written to stderr.
+void set_log_sinks(std::vector<std::shared_ptr<LogSink>> sinks);
+
+void add_log_sink(std::shared_ptr<LogSink> sink);
+
+} // namespace ka
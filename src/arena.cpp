@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <bit>
+#include <new>
+
+#include <ka/common/arena.hpp>
+#include <ka/common/assert.hpp>
+
+namespace ka
+{
+
+//! Blocks start with their header, the memory follows it.
+struct alignas(std::max_align_t) Arena::Block final
+{
+    Block * next;
+    std::size_t size;
+
+    [[nodiscard]] std::byte * begin() noexcept
+    {
+        return reinterpret_cast<std::byte *>(this + 1);
+    }
+
+    [[nodiscard]] std::byte * end() noexcept
+    {
+        return begin() + size;
+    }
+};
+
+Arena::Arena(const std::size_t block_size) noexcept
+    : Arena({}, block_size)
+{
+}
+
+Arena::Arena(const std::span<std::byte> initial, const std::size_t block_size) noexcept
+    : block_size_(block_size)
+    , initial_(initial)
+    , position_(initial.data())
+    , end_(initial.data() + initial.size())
+{
+    AR_PRE(block_size > 0);
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void Arena::rewind(const Mark mark) noexcept
+{
+    while (block_ != mark.block)
+    {
+        auto * const block = block_;
+        block_ = block->next;
+        block->next = spare_;
+        spare_ = block;
+    }
+    position_ = mark.position;
+    end_ = block_ != nullptr ? block_->end() : initial_.data() + initial_.size();
+}
+
+void Arena::reset() noexcept
+{
+    rewind({ nullptr, initial_.data() });
+}
+
+void Arena::release() noexcept
+{
+    reset();
+    while (spare_ != nullptr)
+    {
+        auto * const block = spare_;
+        spare_ = block->next;
+        ::operator delete(block);
+    }
+}
+
+void * Arena::do_allocate(const std::size_t size, const std::size_t alignment)
+{
+    // Containers may ask for nothing, they still expect a distinct non-null pointer.
+    return allocate(std::max<std::size_t>(size, 1), alignment);
+}
+
+void Arena::do_deallocate(void *, std::size_t, std::size_t)
+{
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource & other) const noexcept
+{
+    return this == &other;
+}
+
+void * Arena::allocate_slow(const std::size_t size, const std::size_t alignment)
+{
+    AR_PRE(std::has_single_bit(alignment));
+    // The memory of a block is aligned to max_align_t, only larger alignments may need padding.
+    const auto needed = size + (alignment > alignof(std::max_align_t) ? alignment - alignof(std::max_align_t) : 0);
+    const auto capacity = needed > block_size_ / 4 ? needed : block_size_;
+
+    Block ** spare = &spare_;
+    while (*spare != nullptr && (*spare)->size < needed)
+    {
+        spare = &(*spare)->next;
+    }
+    if (*spare != nullptr)
+    {
+        auto * const block = *spare;
+        *spare = block->next;
+        enter(block);
+    }
+    else
+    {
+        auto * const block = static_cast<Block *>(::operator new(sizeof(Block) + capacity));
+        block->size = capacity;
+        enter(block);
+    }
+    return allocate(size, alignment);
+}
+
+void Arena::enter(Block * const block) noexcept
+{
+    block->next = block_;
+    block_ = block;
+    position_ = block->begin();
+    end_ = block->end();
+}
+
+//! Precedes every block with the pool which carved it out, or nullptr for blocks from the heap.
+struct PoolResource::Header final
+{
+    PoolResource * owner;
+    u32 size_class;
+    //! Distance from the start of a heap block to the memory, which is also its alignment.
+    u32 offset;
+};
+
+//! Takes the place of the memory of a free block.
+struct PoolResource::FreeBlock final
+{
+    FreeBlock * next;
+};
+
+namespace __arena_detail
+{
+
+namespace
+{
+
+constinit thread_local PoolResource * current_pool = nullptr;
+
+struct PoolNode final
+{
+    PoolResource pool;
+    PoolNode * next = nullptr;
+    std::atomic<bool> owned = true;
+};
+
+std::atomic<PoolNode *> all_pools = nullptr;
+
+//! Gives the pool back when the thread exits.
+class PoolOwner final
+{
+public:
+    ~PoolOwner()
+    {
+        if (node_ != nullptr)
+        {
+            current_pool = nullptr;
+            node_->owned.store(false, std::memory_order_release);
+        }
+    }
+
+    void acquire()
+    {
+        for (auto * node = all_pools.load(std::memory_order_acquire); node != nullptr; node = node->next)
+        {
+            bool owned = false;
+            if (!node->owned.load(std::memory_order_relaxed) &&
+                node->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+            {
+                take(node);
+                return;
+            }
+        }
+
+        auto * const node = new PoolNode;
+        node->next = all_pools.load(std::memory_order_relaxed);
+        while (!all_pools.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        take(node);
+    }
+
+private:
+    void take(PoolNode * const node) noexcept
+    {
+        node_ = node;
+        current_pool = &node->pool;
+    }
+
+private:
+    PoolNode * node_ = nullptr;
+};
+
+thread_local PoolOwner pool_owner;
+
+[[nodiscard]] u32 size_class(const std::size_t size) noexcept
+{
+    constexpr auto min_bits = std::bit_width(PoolResource::min_pooled_size - 1);
+    return size <= PoolResource::min_pooled_size ? 0 : static_cast<u32>(std::bit_width(size - 1) - min_bits);
+}
+
+} // namespace
+
+} // namespace __arena_detail
+
+void * PoolResource::allocate(const std::size_t size)
+{
+    static_assert(sizeof(Header) == block_alignment);
+    if (size > max_pooled_size)
+    {
+        return allocate_heap(size, block_alignment);
+    }
+
+    const auto index = __arena_detail::size_class(size);
+    if (free_[index] == nullptr)
+    {
+        free_[index] = remote_free_[index].exchange(nullptr, std::memory_order_acquire);
+    }
+    if (auto * const block = free_[index]; block != nullptr)
+    {
+        free_[index] = block->next;
+        return block;
+    }
+
+    auto * const header = static_cast<std::byte *>(
+        arena_.allocate(sizeof(Header) + (min_pooled_size << index), block_alignment));
+    ::new (header) Header { this, index, static_cast<u32>(sizeof(Header)) };
+    return header + sizeof(Header);
+}
+
+void PoolResource::deallocate(void * const data) noexcept
+{
+    if (data == nullptr)
+    {
+        return;
+    }
+    auto * const memory = static_cast<std::byte *>(data);
+    const auto & header = *reinterpret_cast<const Header *>(memory - sizeof(Header));
+    if (header.owner == nullptr)
+    {
+        ::operator delete(memory - header.offset, std::align_val_t { header.offset });
+        return;
+    }
+
+    auto * const block = ::new (data) FreeBlock;
+    auto & pool = *header.owner;
+    if (&pool == __arena_detail::current_pool)
+    {
+        block->next = pool.free_[header.size_class];
+        pool.free_[header.size_class] = block;
+        return;
+    }
+    // Blocks are only pushed here and the owner takes the whole list at once, which rules out ABA.
+    auto & remote = pool.remote_free_[header.size_class];
+    block->next = remote.load(std::memory_order_relaxed);
+    while (!remote.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+void PoolResource::release() noexcept
+{
+    free_.fill(nullptr);
+    for (auto & remote : remote_free_)
+    {
+        remote.store(nullptr, std::memory_order_relaxed);
+    }
+    arena_.release();
+}
+
+void * PoolResource::do_allocate(const std::size_t size, const std::size_t alignment)
+{
+    return alignment <= block_alignment ? allocate(size) : allocate_heap(size, alignment);
+}
+
+void * PoolResource::allocate_heap(const std::size_t size, const std::size_t alignment)
+{
+    auto * const base = static_cast<std::byte *>(::operator new(alignment + size, std::align_val_t { alignment }));
+    auto * const data = base + alignment;
+    ::new (data - sizeof(Header)) Header { nullptr, 0, static_cast<u32>(alignment) };
+    return data;
+}
+
+void PoolResource::do_deallocate(void * const data, std::size_t, std::size_t)
+{
+    deallocate(data);
+}
+
+bool PoolResource::do_is_equal(const std::pmr::memory_resource & other) const noexcept
+{
+    return this == &other;
+}
+
+PoolResource & thread_pool()
+{
+    if (__arena_detail::current_pool == nullptr) [[unlikely]]
+    {
+        __arena_detail::pool_owner.acquire();
+    }
+    return *__arena_detail::current_pool;
+}
+
+} // namespace ka
@@ -0,0 +1,24 @@
+#include <chrono>
+#include <random>
+
+#include <ka/common/hash.hpp>
+
+namespace ka::__hash_detail
+{
+
+u64 generate_seed() noexcept
+{
+    // The clock mixes in some entropy where random_device is deterministic or unavailable.
+    u64 seed = static_cast<u64>(std::chrono::steady_clock::now().time_since_epoch().count());
+    try
+    {
+        std::random_device device;
+        seed ^= (static_cast<u64>(device()) << 32) | device();
+    }
+    catch (...)
+    {
+    }
+    return multiply_fold(seed ^ secret0, secret1);
+}
+
+} // namespace ka::__hash_detail
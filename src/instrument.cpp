@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ka/common/instrument.hpp>
+#include <ka/common/log.hpp>
+
+#include "log_capture.hpp"
+
+namespace ka
+{
+
+namespace __instrument_detail
+{
+
+constinit thread_local ThreadSlots * thread_slots = nullptr;
+
+namespace
+{
+
+std::mutex & sites_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+//! Sites are static objects, they outlive every use of the registry. Guarded by sites_mutex.
+std::vector<const InstrumentSite *> & sites()
+{
+    static std::vector<const InstrumentSite *> sites;
+    return sites;
+}
+
+std::atomic<ThreadSlots *> all_thread_slots = nullptr;
+
+//! Gives the slots back when the thread exits.
+class ThreadSlotsOwner final
+{
+public:
+    ~ThreadSlotsOwner()
+    {
+        if (thread_slots != nullptr)
+        {
+            thread_slots->owned.store(false, std::memory_order_release);
+            thread_slots = nullptr;
+        }
+    }
+
+    void acquire()
+    {
+        for (auto * slots = all_thread_slots.load(std::memory_order_acquire); slots != nullptr; slots = slots->next)
+        {
+            bool owned = false;
+            if (!slots->owned.load(std::memory_order_relaxed) &&
+                slots->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+            {
+                thread_slots = slots;
+                return;
+            }
+        }
+
+        auto * const slots = new ThreadSlots;
+        slots->next = all_thread_slots.load(std::memory_order_relaxed);
+        while (!all_thread_slots.compare_exchange_weak(
+            slots->next,
+            slots,
+            std::memory_order_release,
+            std::memory_order_relaxed))
+        {
+        }
+        thread_slots = slots;
+    }
+};
+
+thread_local ThreadSlotsOwner thread_slots_owner;
+
+template <LogLevel Level>
+void log_stats(const InstrumentStats & stats)
+{
+    if (stats.kind == InstrumentKind::counter)
+    {
+        __log_detail::submit<Level>(stats.location, "Counter {}: {}", stats.name, stats.count);
+        return;
+    }
+    __log_detail::submit<Level>(
+        stats.location,
+        "Timer {}: {} calls, {} ns total, {} ns mean, {} ns max",
+        stats.name,
+        stats.count,
+        stats.total_nanoseconds,
+        stats.count == 0 ? 0 : stats.total_nanoseconds / stats.count,
+        stats.max_nanoseconds);
+}
+
+//! Background thread of report_instrument_stats.
+class Reporter final
+{
+public:
+    ~Reporter()
+    {
+        stop();
+    }
+
+    void start(const std::chrono::milliseconds period, const LogLevel level)
+    {
+        stop();
+        stop_ = false;
+        thread_ = std::thread(
+            [this, period, level]
+            {
+                std::unique_lock lock(mutex_);
+                while (!wake_.wait_for(lock, period, [this] { return stop_; }))
+                {
+                    lock.unlock();
+                    log_instrument_stats(level);
+                    lock.lock();
+                }
+            });
+    }
+
+    void stop()
+    {
+        if (!thread_.joinable())
+        {
+            return;
+        }
+        {
+            const std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace
+
+InstrumentSite::InstrumentSite(
+    const InstrumentKind kind,
+    const std::string_view name,
+    const std::source_location & location)
+    : name_(name)
+    , location_(location)
+    , kind_(kind)
+{
+    const std::lock_guard lock(sites_mutex());
+    auto & registered = sites();
+    if (registered.size() == max_sites)
+    {
+        log_fatal("More than {} instrumented sites", max_sites);
+        std::abort();
+    }
+    id_ = static_cast<u32>(registered.size());
+    registered.push_back(this);
+}
+
+InstrumentSlot & allocate_slot(const u32 id)
+{
+    if (thread_slots == nullptr)
+    {
+        thread_slots_owner.acquire();
+    }
+    auto & chunk = thread_slots->chunks[id >> slot_chunk_bits];
+    auto * chunk_slots = chunk.load(std::memory_order_relaxed);
+    if (chunk_slots == nullptr)
+    {
+        chunk_slots = new InstrumentSlotChunk;
+        chunk.store(chunk_slots, std::memory_order_release);
+    }
+    return chunk_slots->slots[id & (slot_chunk_size - 1)];
+}
+
+} // namespace __instrument_detail
+
+std::vector<InstrumentStats> instrument_stats()
+{
+    using namespace __instrument_detail;
+    std::vector<InstrumentStats> result;
+    {
+        const std::lock_guard lock(sites_mutex());
+        result.reserve(sites().size());
+        for (const auto * const site : sites())
+        {
+            result.push_back({ site->name(), site->location(), site->kind(), 0, 0, 0 });
+        }
+    }
+
+    // Ticks are summed per site first and converted once.
+    std::vector<u64> max_ticks(result.size());
+    std::vector<u64> ticks(result.size());
+    for (auto * slots = all_thread_slots.load(std::memory_order_acquire); slots != nullptr; slots = slots->next)
+    {
+        for (std::size_t first = 0; first < result.size(); first += slot_chunk_size)
+        {
+            const auto * const chunk = slots->chunks[first >> slot_chunk_bits].load(std::memory_order_acquire);
+            if (chunk == nullptr)
+            {
+                continue;
+            }
+            for (std::size_t i = first; i < std::min(result.size(), first + slot_chunk_size); ++i)
+            {
+                const auto & slot = chunk->slots[i - first];
+                result[i].count += slot.count.load(std::memory_order_relaxed);
+                ticks[i] += slot.ticks.load(std::memory_order_relaxed);
+                max_ticks[i] = std::max(max_ticks[i], slot.max_ticks.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    static __log_detail::TickConverter converter;
+    static std::mutex converter_mutex;
+    const std::lock_guard lock(converter_mutex);
+    converter.update();
+    for (std::size_t i = 0; i < result.size(); ++i)
+    {
+        result[i].total_nanoseconds = converter.to_duration(ticks[i]);
+        result[i].max_nanoseconds = converter.to_duration(max_ticks[i]);
+    }
+    return result;
+}
+
+void log_instrument_stats(const LogLevel level)
+{
+    for (const auto & stats : instrument_stats())
+    {
+        switch (level)
+        {
+        case LogLevel::debug:
+            __instrument_detail::log_stats<LogLevel::debug>(stats);
+            break;
+        case LogLevel::info:
+            __instrument_detail::log_stats<LogLevel::info>(stats);
+            break;
+        case LogLevel::warning:
+            __instrument_detail::log_stats<LogLevel::warning>(stats);
+            break;
+        case LogLevel::error:
+            __instrument_detail::log_stats<LogLevel::error>(stats);
+            break;
+        case LogLevel::fatal:
+            __instrument_detail::log_stats<LogLevel::fatal>(stats);
+            break;
+        }
+    }
+}
+
+void report_instrument_stats(const std::chrono::milliseconds period, const LogLevel level)
+{
+    static __instrument_detail::Reporter reporter;
+    static std::mutex mutex;
+    const std::lock_guard lock(mutex);
+    if (period.count() <= 0)
+    {
+        reporter.stop();
+        return;
+    }
+    reporter.start(period, level);
+}
+
+} // namespace ka
@@ -0,0 +1,107 @@
+#include <stdexcept>
+
+#include <ka/common/intern.hpp>
+
+namespace ka
+{
+
+StringPool::~StringPool()
+{
+    for (auto & shard : shards_)
+    {
+        for (auto & chunk : shard.chunks)
+        {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+InternedStr StringPool::intern(const std::string_view str)
+{
+    const Key key { str, StrHash<> {}(str) };
+    const auto index = shard_index(key.digest);
+    auto & shard = shards_[index];
+    {
+        const std::shared_lock lock(shard.mutex);
+        if (const auto found = shard.index.find(key); found != shard.index.end())
+        {
+            return InternedStr(found->second);
+        }
+    }
+
+    const std::lock_guard lock(shard.mutex);
+    // Another thread may have interned the string while the lock was released.
+    if (const auto found = shard.index.find(key); found != shard.index.end())
+    {
+        return InternedStr(found->second);
+    }
+    return insert(shard, index, key);
+}
+
+std::optional<InternedStr> StringPool::find(const std::string_view str) const
+{
+    const Key key { str, StrHash<> {}(str) };
+    const auto & shard = shards_[shard_index(key.digest)];
+    const std::shared_lock lock(shard.mutex);
+    if (const auto found = shard.index.find(key); found != shard.index.end())
+    {
+        return InternedStr(found->second);
+    }
+    return std::nullopt;
+}
+
+size_t StringPool::size() const
+{
+    size_t result = 0;
+    for (const auto & shard : shards_)
+    {
+        const std::shared_lock lock(shard.mutex);
+        result += shard.size;
+    }
+    return result;
+}
+
+InternedStr StringPool::insert(Shard & shard, const size_t index, const Key & key)
+{
+    if (shard.size == max_shard_size)
+    {
+        throw std::length_error("StringPool shard is full");
+    }
+
+    const auto position = shard.size + first_chunk_size;
+    const auto chunk = static_cast<size_t>(std::bit_width(position)) - first_chunk_bits - 1;
+    auto * entries = shard.chunks[chunk].load(std::memory_order_relaxed);
+    if (entries == nullptr)
+    {
+        entries = new Entry[first_chunk_size << chunk];
+        shard.chunks[chunk].store(entries, std::memory_order_release);
+    }
+
+    const auto size = key.str.size() + 1;
+    char * data = nullptr;
+    if (size > arena_block_size / 4)
+    {
+        data = shard.blocks.emplace_back(std::make_unique_for_overwrite<char[]>(size)).get();
+    }
+    else
+    {
+        if (shard.free_size < size)
+        {
+            shard.free = shard.blocks.emplace_back(std::make_unique_for_overwrite<char[]>(arena_block_size)).get();
+            shard.free_size = arena_block_size;
+        }
+        data = shard.free;
+        shard.free += size;
+        shard.free_size -= size;
+    }
+    key.str.copy(data, key.str.size());
+    data[key.str.size()] = '\0';
+
+    const auto handle = static_cast<u32>((shard.size << shard_bits) | index);
+    shard.index.try_emplace(Key { std::string_view(data, key.str.size()), key.digest }, handle);
+    entries[position - (first_chunk_size << chunk)] = { data, key.str.size(), key.digest };
+    ++shard.size;
+    return InternedStr(handle);
+}
+
+} // namespace ka
@@ -1,46 +1,114 @@
-#include <filesystem>
-
-#ifdef _MSC_VER
-    #pragma warning(push)
-    #pragma warning(disable : 4996)
-    #include <fmt/format.h>
-    #pragma warning(pop)
-#else
-    #include <fmt/format.h>
-#endif
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <string_view>
 
+#include <ka/common/assert.hpp>
 #include <ka/common/log.hpp>
 
+#include "log_backend.hpp"
+#include "log_flight.hpp"
+#include "log_format.hpp"
+
 namespace ka
 {
 
 namespace __log_detail
 {
 
-std::string format_message(
-    const std::string_view type,
-    const std::source_location & location,
-    const std::string_view message)
-{
-    constexpr auto here = std::source_location::current().file_name();
-    const auto root = std::filesystem::path(here).parent_path().parent_path().parent_path();
-    return fmt::format(
-        "{} ({}:{}.{}) {}",
-        type,
-        std::filesystem::path(location.file_name()).lexically_proximate(root).string(),
+std::atomic<LogLevel> runtime_log_level = LogLevel::debug;
+std::atomic<LogLevel> flight_recorder_level = flight_recorder_off;
+std::atomic<LogLevel> submit_log_level = LogLevel::debug;
+
+void update_submit_log_level()
+{
+    // Concurrent updates are ordered, the last one sees both levels stored before it.
+    static std::mutex mutex;
+    const std::lock_guard lock(mutex);
+    const auto level = runtime_log_level.load(std::memory_order_relaxed);
+    submit_log_level.store(
+        std::min(level, flight_recorder_level.load(std::memory_order_relaxed)),
+        std::memory_order_relaxed);
+}
+
+void format_record(
+    fmt::memory_buffer & out,
+    TimestampFormatter & timestamps,
+    const LogRecord & record,
+    const u64 nanoseconds)
+{
+    const auto & location = record.location();
+    format_prefix(
+        out,
+        timestamps,
+        record.level(),
+        nanoseconds,
+        record.thread_id(),
+        trim_source_path(location.file_name()),
         location.line(),
-        location.column(),
-        message);
+        location.column());
+    record.format_message(fmt::appender(out));
+    format_suffix(out, record.suppressed());
+}
+
+PendingRecord begin_record(
+    const LogLevel level,
+    const std::source_location & location,
+    const u32 suppressed,
+    const fmt::string_view format,
+    const FormatFn formatter,
+    const std::size_t args_size)
+{
+    return LogBackend::instance().begin(level, location, suppressed, format, formatter, args_size);
+}
+
+void commit_record(const PendingRecord record)
+{
+    LogBackend::instance().commit(record);
 }
 
 } // namespace __log_detail
 
+namespace __assert_detail
+{
+
+void assert_failed(const AssertSite & site, const std::source_location & location)
+{
+    log_assert(site.assert_type, site.condition, location);
+    std::abort();
+}
+
+} // namespace __assert_detail
+
+void set_log_level(const LogLevel level) noexcept
+{
+    __log_detail::runtime_log_level.store(std::min(level, LogLevel::fatal), std::memory_order_relaxed);
+    __log_detail::update_submit_log_level();
+}
+
+LogLevel log_level() noexcept
+{
+    return __log_detail::runtime_log_level.load(std::memory_order_relaxed);
+}
+
+void set_log_mode(const LogMode mode)
+{
+    __log_detail::LogBackend::instance().set_mode(mode);
+}
+
+void log_flush()
+{
+    __log_detail::LogBackend::instance().flush();
+}
+
 void log_assert(
     const std::string_view assert_type,
     const std::string_view condition,
     const std::source_location & location)
 {
-    log_fatal(fmt::format("{} failed: AR_ASSERT({})", assert_type, condition), location);
+    __log_detail::submit<LogLevel::fatal>(location, "{} failed: AR_ASSERT({})", assert_type, condition);
+    __log_detail::dump_flight_recorder_on_crash();
 }
 
 } // namespace ka
@@ -0,0 +1,196 @@
+#include <cstdlib>
+#include <string_view>
+#include <utility>
+
+#include "log_backend.hpp"
+
+namespace ka::__log_detail
+{
+
+namespace
+{
+
+constexpr int stderr_fd = 2;
+
+} // namespace
+
+LogBackend & LogBackend::instance()
+{
+    // Never destroyed: records may still be submitted from static destructors after the consumer thread is stopped.
+    static LogBackend * const backend = []
+    {
+        auto * const result = new LogBackend();
+        std::atexit([] { instance().shutdown(); });
+        return result;
+    }();
+    return *backend;
+}
+
+LogBackend::LogBackend()
+    : queue_(queue_capacity)
+    , sinks_ { std::make_shared<FdLogSink>(stderr_fd) }
+    , consumer_([this] { run(); })
+{
+}
+
+PendingRecord LogBackend::begin(
+    const LogLevel level,
+    const std::source_location & location,
+    const u32 suppressed,
+    const fmt::string_view format,
+    const FormatFn formatter,
+    const std::size_t args_size)
+{
+    auto position = queue_.try_reserve();
+    while (!position)
+    {
+        // The queue is full: help the consumer instead of dropping the record.
+        if (std::unique_lock lock(drain_mutex_, std::try_to_lock); lock.owns_lock())
+        {
+            drain();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+        position = queue_.try_reserve();
+    }
+    return { *position, queue_[*position].assign(level, location, suppressed, format, formatter, args_size) };
+}
+
+void LogBackend::commit(const PendingRecord record)
+{
+    const auto level = queue_[record.position].level();
+    queue_.publish(record.position);
+
+    if (level == LogLevel::fatal || mode_.load(std::memory_order_relaxed) == LogMode::synchronous)
+    {
+        flush();
+    }
+    else if (consumer_sleeping_.load(std::memory_order_relaxed))
+    {
+        // A notification lost to a race only delays the batch until idle_timeout.
+        wake_.notify_one();
+    }
+}
+
+void LogBackend::flush()
+{
+    const std::lock_guard lock(drain_mutex_);
+    drain();
+}
+
+void LogBackend::set_mode(const LogMode mode) noexcept
+{
+    mode_.store(mode, std::memory_order_relaxed);
+}
+
+void LogBackend::set_sinks(std::vector<std::shared_ptr<LogSink>> sinks)
+{
+    const std::lock_guard lock(drain_mutex_);
+    drain();
+    sinks_.swap(sinks);
+    update_encodings();
+}
+
+void LogBackend::add_sink(std::shared_ptr<LogSink> sink)
+{
+    const std::lock_guard lock(drain_mutex_);
+    drain();
+    sinks_.push_back(std::move(sink));
+    update_encodings();
+}
+
+void LogBackend::run()
+{
+    for (;;)
+    {
+        {
+            const std::lock_guard lock(drain_mutex_);
+            drain();
+        }
+
+        std::unique_lock lock(wake_mutex_);
+        if (stop_)
+        {
+            break;
+        }
+        consumer_sleeping_.store(true, std::memory_order_relaxed);
+        wake_.wait_for(lock, idle_timeout, [this] { return stop_ || !queue_.empty(); });
+        consumer_sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+void LogBackend::shutdown()
+{
+    {
+        const std::lock_guard lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    consumer_.join();
+
+    set_mode(LogMode::synchronous);
+    flush();
+}
+
+void LogBackend::drain()
+{
+    ticks_.update();
+    while (queue_.try_pop(
+        [this](LogRecord & record)
+        {
+            const auto nanoseconds = ticks_.to_nanoseconds(record.ticks());
+            if (has_text_sinks_)
+            {
+                format_record(text_batch_.buffer(), timestamps_, record, nanoseconds);
+                text_batch_.end_record();
+            }
+            if (has_binary_sinks_)
+            {
+                binary_encoder_.encode(binary_batch_.buffer(), record, nanoseconds);
+                binary_batch_.end_record();
+            }
+            record.release();
+        }))
+    {
+        if (text_batch_.size() + binary_batch_.size() >= batch_size_limit)
+        {
+            write_batch();
+        }
+    }
+    write_batch();
+    for (const auto & sink : sinks_)
+    {
+        sink->flush();
+    }
+}
+
+void LogBackend::write_batch()
+{
+    if (text_batch_.size() == 0 && binary_batch_.size() == 0)
+    {
+        return;
+    }
+    const auto text_records = text_batch_.records();
+    const auto binary_records = binary_batch_.records();
+    for (const auto & sink : sinks_)
+    {
+        sink->write(sink->encoding() == LogEncoding::binary ? binary_records : text_records);
+    }
+    text_batch_.clear();
+    binary_batch_.clear();
+}
+
+void LogBackend::update_encodings() noexcept
+{
+    has_text_sinks_ = false;
+    has_binary_sinks_ = false;
+    for (const auto & sink : sinks_)
+    {
+        (sink->encoding() == LogEncoding::binary ? has_binary_sinks_ : has_text_sinks_) = true;
+    }
+    binary_encoder_.reset();
+}
+
+} // namespace ka::__log_detail
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable : 4996)
+    #include <fmt/format.h>
+    #pragma warning(pop)
+#else
+    #include <fmt/format.h>
+#endif
+
+#include <ka/common/log.hpp>
+#include <ka/common/log_sink.hpp>
+
+#include "log_binary.hpp"
+#include "log_capture.hpp"
+#include "log_format.hpp"
+#include "log_queue.hpp"
+#include "log_record.hpp"
+
+namespace ka::__log_detail
+{
+
+//! Appends the text encoding of the record, nanoseconds is its time since the Unix epoch.
+void format_record(
+    fmt::memory_buffer & out,
+    TimestampFormatter & timestamps,
+    const LogRecord & record,
+    u64 nanoseconds);
+
+//! Records of one encoding written into a single buffer.
+class LogBatch final
+{
+public:
+    [[nodiscard]] fmt::memory_buffer & buffer() noexcept
+    {
+        return buffer_;
+    }
+
+    //! Marks the end of the record written last.
+    void end_record()
+    {
+        ends_.push_back(buffer_.size());
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return buffer_.size();
+    }
+
+    //! Views of the records, valid until clear().
+    [[nodiscard]] std::span<const std::string_view> records()
+    {
+        std::size_t begin = 0;
+        for (const auto end : ends_)
+        {
+            records_.emplace_back(buffer_.data() + begin, end - begin);
+            begin = end;
+        }
+        return records_;
+    }
+
+    void clear() noexcept
+    {
+        buffer_.clear();
+        ends_.clear();
+        records_.clear();
+    }
+
+private:
+    fmt::memory_buffer buffer_;
+    std::vector<std::size_t> ends_;
+    std::vector<std::string_view> records_;
+};
+
+//! Owns the record queue and the consumer thread which formats and writes queued records in batches.
+//! Whoever drains the queue holds drain_mutex_, this keeps the queue single-consumer and lets producers drain it
+//! themselves when they need a synchronous write.
+class LogBackend final
+{
+public:
+    [[nodiscard]] static LogBackend & instance();
+
+    [[nodiscard]] PendingRecord begin(
+        LogLevel level,
+        const std::source_location & location,
+        u32 suppressed,
+        fmt::string_view format,
+        FormatFn formatter,
+        std::size_t args_size);
+    void commit(PendingRecord record);
+    void flush();
+    void set_mode(LogMode mode) noexcept;
+    void set_sinks(std::vector<std::shared_ptr<LogSink>> sinks);
+    void add_sink(std::shared_ptr<LogSink> sink);
+
+private:
+    LogBackend();
+
+    void run();
+    void shutdown();
+    //! Requires drain_mutex_ to be held.
+    void drain();
+    //! Requires drain_mutex_ to be held.
+    void write_batch();
+    //! Requires drain_mutex_ to be held.
+    void update_encodings() noexcept;
+
+private:
+    constexpr static std::size_t queue_capacity = 4096;
+    constexpr static std::size_t batch_size_limit = 64 * 1024;
+    constexpr static auto idle_timeout = std::chrono::milliseconds(20);
+
+private:
+    BoundedQueue<LogRecord> queue_;
+    std::atomic<LogMode> mode_ = LogMode::asynchronous;
+
+    std::mutex drain_mutex_;
+    std::vector<std::shared_ptr<LogSink>> sinks_;
+    bool has_text_sinks_ = true;
+    bool has_binary_sinks_ = false;
+    TickConverter ticks_;
+    TimestampFormatter timestamps_;
+    LogBatch text_batch_;
+    LogBatch binary_batch_;
+    BinaryLogEncoder binary_encoder_;
+
+    std::atomic<bool> consumer_sleeping_ = false;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread consumer_;
+};
+
+} // namespace ka::__log_detail
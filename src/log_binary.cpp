@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#include "log_binary.hpp"
+#include "log_format.hpp"
+
+namespace ka::__log_detail
+{
+
+namespace
+{
+
+template <typename T>
+void append(fmt::memory_buffer & out, const T & value)
+{
+    const auto * const data = reinterpret_cast<const char *>(&value);
+    out.append(data, data + sizeof(T));
+}
+
+void append_string(fmt::memory_buffer & out, const std::string_view value)
+{
+    binary_log::append_varint(out, value.size());
+    out.append(value.data(), value.data() + value.size());
+}
+
+template <typename T>
+[[nodiscard]] T read(const std::byte *& in) noexcept
+{
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+}
+
+//! Rewrites arguments from the fixed-size layout of records to the compact layout of the stream.
+void append_args(fmt::memory_buffer & out, const std::span<const std::byte> args)
+{
+    const auto count = static_cast<std::size_t>(args[0]);
+    const auto * const types = args.data() + 1;
+    const auto * in = types + count;
+    out.append(reinterpret_cast<const char *>(args.data()), reinterpret_cast<const char *>(in));
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        switch (static_cast<ArgType>(types[i]))
+        {
+        case ArgType::boolean:
+            append(out, read<bool>(in));
+            break;
+        case ArgType::character:
+            append(out, read<char>(in));
+            break;
+        case ArgType::signed_integer:
+            binary_log::append_varint(out, binary_log::zigzag(read<s64>(in)));
+            break;
+        case ArgType::unsigned_integer:
+            binary_log::append_varint(out, read<u64>(in));
+            break;
+        case ArgType::float32:
+            append(out, read<f32>(in));
+            break;
+        case ArgType::float64:
+            append(out, read<f64>(in));
+            break;
+        case ArgType::pointer:
+            binary_log::append_varint(out, reinterpret_cast<std::uintptr_t>(read<const void *>(in)));
+            break;
+        case ArgType::string:
+        {
+            const auto size = read<u32>(in);
+            append_string(out, std::string_view(reinterpret_cast<const char *>(in), size));
+            in += size;
+            break;
+        }
+        }
+    }
+}
+
+} // namespace
+
+void BinaryLogEncoder::Site::hash(Hasher & hasher) const noexcept
+{
+    hasher.update(reinterpret_cast<std::uintptr_t>(file));
+    hasher.update(reinterpret_cast<std::uintptr_t>(format));
+    hasher.update(line);
+    hasher.update(column);
+    hasher.update(level);
+}
+
+void BinaryLogEncoder::reset() noexcept
+{
+    started_ = false;
+}
+
+void BinaryLogEncoder::encode(fmt::memory_buffer & out, const LogRecord & record, const u64 nanoseconds)
+{
+    if (!started_)
+    {
+        sites_.clear();
+        append(out, binary_log::Entry::stream_start);
+        out.append(binary_log::magic.data(), binary_log::magic.data() + binary_log::magic.size());
+        append(out, binary_log::version);
+        last_timestamp_ = 0;
+        started_ = true;
+    }
+
+    const auto & location = record.location();
+    const Site site {
+        .file = location.file_name(),
+        .format = record.format().data(),
+        .line = location.line(),
+        .column = location.column(),
+        .level = record.level(),
+    };
+    const auto [it, inserted] = sites_.try_emplace(site, static_cast<u32>(sites_.size()));
+    if (inserted)
+    {
+        append(out, binary_log::Entry::site);
+        binary_log::append_varint(out, it->second);
+        append(out, site.level);
+        binary_log::append_varint(out, site.line);
+        binary_log::append_varint(out, site.column);
+        append_string(out, trim_source_path(site.file));
+        append_string(out, std::string_view(record.format().data(), record.format().size()));
+    }
+
+    // Records of different threads may be slightly out of order.
+    const auto timestamp = std::max(nanoseconds, last_timestamp_);
+    append(out, binary_log::Entry::record);
+    binary_log::append_varint(out, it->second);
+    binary_log::append_varint(out, timestamp - last_timestamp_);
+    last_timestamp_ = timestamp;
+    binary_log::append_varint(out, record.thread_id());
+    binary_log::append_varint(out, record.suppressed());
+    append_args(out, record.args());
+}
+
+} // namespace ka::__log_detail
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <unordered_map>
+
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable : 4996)
+    #include <fmt/format.h>
+    #pragma warning(pop)
+#else
+    #include <fmt/format.h>
+#endif
+
+#include <ka/common/fixed.hpp>
+#include <ka/common/hash.hpp>
+#include <ka/common/log.hpp>
+
+#include "log_record.hpp"
+
+namespace ka::__log_detail
+{
+
+//! Binary log stream. Every entry starts with its u8 Entry type:
+//!  - stream_start: magic, u32 version. Forgets all sites and the timestamp of the previous record.
+//!  - site: varint site, u8 level, varint line, varint column, string file, string format.
+//!  - record: varint site, varint nanoseconds since the previous record, varint thread, varint suppressed, args.
+//! Strings are a varint size followed by the characters, fixed-size numbers are in the native byte order.
+//! Varints are unsigned LEB128. The first timestamp in a stream is nanoseconds since the Unix epoch.
+//! Args are u8 count, u8 ArgType of each argument and then the values: signed integers are zigzag varints,
+//! unsigned integers and pointers are varints, strings are strings, other types are copied as is.
+namespace binary_log
+{
+
+constexpr std::array<char, 8> magic = { 'K', 'A', 'L', 'O', 'G', 'B', 'I', 'N' };
+constexpr u32 version = 3;
+
+enum class Entry : u8
+{
+    stream_start,
+    site,
+    record,
+};
+
+inline void append_varint(fmt::memory_buffer & out, u64 value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+[[nodiscard]] constexpr u64 zigzag(const s64 value) noexcept
+{
+    return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+}
+
+[[nodiscard]] constexpr s64 unzigzag(const u64 value) noexcept
+{
+    return static_cast<s64>(value >> 1) ^ -static_cast<s64>(value & 1);
+}
+
+} // namespace binary_log
+
+//! Each call site is written once as a site entry, its records refer to it by a number.
+class BinaryLogEncoder final
+{
+public:
+    //! The next record starts a new stream, so sinks added later receive all site definitions.
+    void reset() noexcept;
+
+    //! Appends the record, preceded by stream_start and site entries when needed.
+    //! Nanoseconds is the time of the record since the Unix epoch.
+    void encode(fmt::memory_buffer & out, const LogRecord & record, u64 nanoseconds);
+
+private:
+    struct Site final
+    {
+        const char * file;
+        const char * format;
+        u32 line;
+        u32 column;
+        LogLevel level;
+
+        [[nodiscard]] bool operator==(const Site &) const noexcept = default;
+
+        void hash(Hasher & hasher) const noexcept;
+    };
+
+private:
+    std::unordered_map<Site, u32, Hash<>> sites_;
+    u64 last_timestamp_ = 0;
+    bool started_ = false;
+};
+
+} // namespace ka::__log_detail
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include <ka/common/fixed.hpp>
+#include <ka/common/instrument.hpp>
+
+namespace ka::__log_detail
+{
+
+//! Records are stamped with ticks, which the consumer converts to wall-clock time, see TickConverter.
+using ::ka::read_ticks;
+
+[[nodiscard]] inline u32 read_thread_id() noexcept
+{
+#if defined(_WIN32)
+    return static_cast<u32>(::GetCurrentThreadId());
+#elif defined(__linux__)
+    return static_cast<u32>(::syscall(SYS_gettid));
+#else
+    static std::atomic<u32> next_id = 1;
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+//! The id of the calling thread, it is asked from the OS only once per thread.
+[[nodiscard]] inline u32 current_thread_id() noexcept
+{
+    thread_local const u32 id = read_thread_id();
+    return id;
+}
+
+//! Converts ticks to nanoseconds since the Unix epoch.
+//! The tick rate is measured against steady_clock between the first reading and the latest one, readings are
+//! retaken every calibration_period so the conversion follows adjustments of the system clock.
+class TickConverter final
+{
+public:
+    constexpr static auto calibration_period = std::chrono::seconds(1);
+
+    //! Spends initial_calibration measuring the tick rate.
+    TickConverter() noexcept
+        : first_(take_reading())
+    {
+        while (std::chrono::steady_clock::now() - first_.steady < initial_calibration)
+        {
+        }
+        recalibrate();
+    }
+
+    //! Takes a new reading if the latest one is older than calibration_period.
+    void update() noexcept
+    {
+        if (std::chrono::steady_clock::now() - latest_.steady >= calibration_period)
+        {
+            recalibrate();
+        }
+    }
+
+    [[nodiscard]] u64 to_nanoseconds(const u64 ticks) const noexcept
+    {
+        const auto elapsed = static_cast<f64>(static_cast<s64>(ticks - latest_.ticks)) * nanoseconds_per_tick_;
+        return static_cast<u64>(latest_.system + static_cast<s64>(elapsed));
+    }
+
+    //! Converts a difference of ticks.
+    [[nodiscard]] u64 to_duration(const u64 ticks) const noexcept
+    {
+        return static_cast<u64>(static_cast<f64>(ticks) * nanoseconds_per_tick_);
+    }
+
+private:
+    constexpr static auto initial_calibration = std::chrono::microseconds(500);
+
+    struct Reading final
+    {
+        u64 ticks;
+        std::chrono::steady_clock::time_point steady;
+        s64 system;
+    };
+
+private:
+    [[nodiscard]] static Reading take_reading() noexcept
+    {
+        const auto steady = std::chrono::steady_clock::now();
+        const auto ticks = read_ticks();
+        const auto system = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::system_clock::now().time_since_epoch())
+                                .count();
+        return { ticks, steady, system };
+    }
+
+    void recalibrate() noexcept
+    {
+        latest_ = take_reading();
+        const auto steady = std::chrono::duration<f64, std::nano>(latest_.steady - first_.steady).count();
+        if (latest_.ticks != first_.ticks)
+        {
+            nanoseconds_per_tick_ = steady / static_cast<f64>(latest_.ticks - first_.ticks);
+        }
+    }
+
+private:
+    Reading first_;
+    Reading latest_ {};
+    f64 nanoseconds_per_tick_ = 1;
+};
+
+} // namespace ka::__log_detail
@@ -0,0 +1,422 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string_view>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <signal.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable : 4996)
+    #include <fmt/format.h>
+    #pragma warning(pop)
+#else
+    #include <fmt/format.h>
+#endif
+
+#include <ka/common/log.hpp>
+
+#include "log_capture.hpp"
+#include "log_flight.hpp"
+#include "log_format.hpp"
+#include "log_record.hpp"
+
+namespace ka
+{
+
+namespace __log_detail
+{
+
+namespace
+{
+
+//! Record kept by the flight recorder. Arguments which don't fit are dropped, the formatter is nullptr then.
+struct FlightEntry final
+{
+    u64 ticks;
+    std::source_location location;
+    const char * format;
+    FormatFn formatter;
+    u32 format_size;
+    u32 thread_id;
+    u32 suppressed;
+    LogLevel level;
+    std::array<std::byte, LogRecord::inline_capacity> args;
+};
+
+//! The sequence is odd while the entry is written and 2 * position + 2 once the entry of that position is complete.
+//! Readers compare it before and after copying the entry.
+struct FlightSlot final
+{
+    std::atomic<u64> sequence = 0;
+    FlightEntry entry;
+};
+
+//! Ring of the latest records of one thread, only the owning thread writes it.
+//! Rings are never freed, a signal handler may read them at any time. The ring of a thread which has exited is
+//! taken over by the next thread which needs one.
+struct FlightRing final
+{
+    explicit FlightRing(const std::size_t capacity)
+        : slots(std::make_unique<FlightSlot[]>(capacity))
+        , mask(capacity - 1)
+    {
+    }
+
+    std::unique_ptr<FlightSlot[]> slots;
+    u64 mask;
+    FlightRing * next = nullptr;
+    std::atomic<bool> owned = true;
+    //! Number of records written into the ring.
+    std::atomic<u64> written = 0;
+
+    // State of the running dump.
+    u64 dump_position = 0;
+    u64 dump_end = 0;
+    bool dump_loaded = false;
+    FlightEntry dump_entry {};
+};
+
+//! Everything a dump needs, allocated up front so that dumping doesn't allocate.
+struct FlightDumpState final
+{
+    //! Formatted records are written once the buffer holds this many bytes.
+    constexpr static std::size_t write_threshold = 32 * 1024;
+
+    FlightDumpState()
+    {
+        buffer.reserve(2 * write_threshold);
+    }
+
+    TickConverter ticks;
+    TimestampFormatter timestamps;
+    fmt::memory_buffer buffer;
+};
+
+std::atomic<FlightRing *> flight_rings = nullptr;
+std::atomic<std::size_t> flight_ring_capacity = FlightRecorderOptions {}.records_per_thread;
+std::atomic<int> flight_fd = 2;
+std::atomic<FlightDumpState *> flight_dump_state = nullptr;
+std::atomic_flag flight_dumping;
+std::atomic_flag crash_dumped;
+
+std::mutex flight_options_mutex;
+bool signal_handlers_installed = false;
+
+#ifdef _WIN32
+constexpr std::array fatal_signals { SIGSEGV, SIGFPE, SIGILL, SIGABRT };
+std::array<void (*)(int), fatal_signals.size()> previous_handlers {};
+#else
+constexpr std::array fatal_signals { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+std::array<struct sigaction, fatal_signals.size()> previous_actions {};
+#endif
+
+[[nodiscard]] FlightRing & acquire_ring()
+{
+    for (auto * ring = flight_rings.load(std::memory_order_acquire); ring != nullptr; ring = ring->next)
+    {
+        bool owned = false;
+        if (!ring->owned.load(std::memory_order_relaxed) &&
+            ring->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+        {
+            return *ring;
+        }
+    }
+
+    auto * const ring = new FlightRing(flight_ring_capacity.load(std::memory_order_relaxed));
+    ring->next = flight_rings.load(std::memory_order_relaxed);
+    while (!flight_rings.compare_exchange_weak(
+        ring->next,
+        ring,
+        std::memory_order_release,
+        std::memory_order_relaxed))
+    {
+    }
+    return *ring;
+}
+
+//! Gives the ring back when the thread exits.
+class ThreadRing final
+{
+public:
+    ~ThreadRing()
+    {
+        if (ring_ != nullptr)
+        {
+            ring_->owned.store(false, std::memory_order_release);
+        }
+    }
+
+    [[nodiscard]] FlightRing & get()
+    {
+        if (ring_ == nullptr) [[unlikely]]
+        {
+            ring_ = &acquire_ring();
+        }
+        return *ring_;
+    }
+
+    //! The ring taken by get.
+    [[nodiscard]] FlightRing & current() const noexcept
+    {
+        return *ring_;
+    }
+
+private:
+    FlightRing * ring_ = nullptr;
+};
+
+thread_local ThreadRing thread_ring;
+
+//! Copies the next complete record of the ring into dump_entry, records overwritten meanwhile are skipped.
+[[nodiscard]] bool load_next(FlightRing & ring) noexcept
+{
+    while (ring.dump_position < ring.dump_end)
+    {
+        const auto position = ring.dump_position++;
+        const auto & slot = ring.slots[position & ring.mask];
+        const auto sequence = 2 * position + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != sequence)
+        {
+            continue;
+        }
+        ring.dump_entry = slot.entry;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void format_entry(FlightDumpState & state, const FlightEntry & entry)
+{
+    auto & out = state.buffer;
+    const auto & location = entry.location;
+    format_prefix(
+        out,
+        state.timestamps,
+        entry.level,
+        state.ticks.to_nanoseconds(entry.ticks),
+        entry.thread_id,
+        trim_source_path(location.file_name()),
+        location.line(),
+        location.column());
+    const fmt::string_view format(entry.format, entry.format_size);
+    if (entry.formatter != nullptr)
+    {
+        entry.formatter(fmt::appender(out), format, entry.args.data());
+    }
+    else
+    {
+        out.append(format);
+        out.append(std::string_view(" [arguments dropped]"));
+    }
+    format_suffix(out, entry.suppressed);
+}
+
+//! Only calls functions which are async-signal-safe.
+void write_fd(const int fd, std::string_view data) noexcept
+{
+    while (!data.empty())
+    {
+#ifdef _WIN32
+        const auto size = static_cast<unsigned>(std::min<std::size_t>(data.size(), 1 << 30));
+        const auto written = ::_write(fd, data.data(), size);
+#else
+        const auto written = ::write(fd, data.data(), data.size());
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+#endif
+        if (written < 0)
+        {
+            return;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+}
+
+void write_buffer(const int fd, fmt::memory_buffer & buffer) noexcept
+{
+    write_fd(fd, std::string_view(buffer.data(), buffer.size()));
+    buffer.clear();
+}
+
+void handle_fatal_signal(const int signal) noexcept
+{
+    const auto saved_errno = errno;
+    dump_flight_recorder_on_crash();
+    errno = saved_errno;
+
+    // The signal is blocked while the handler runs, the restored handler receives it once this one returns.
+    const auto index = static_cast<std::size_t>(std::ranges::find(fatal_signals, signal) - fatal_signals.begin());
+#ifdef _WIN32
+    std::signal(signal, previous_handlers[index]);
+#else
+    ::sigaction(signal, &previous_actions[index], nullptr);
+#endif
+    std::raise(signal);
+}
+
+void install_signal_handlers()
+{
+#ifdef _WIN32
+    for (std::size_t i = 0; i < fatal_signals.size(); ++i)
+    {
+        previous_handlers[i] = std::signal(fatal_signals[i], handle_fatal_signal);
+    }
+#else
+    struct sigaction action {};
+    action.sa_handler = handle_fatal_signal;
+    // Stack overflows are reported on threads which have set up an alternate signal stack.
+    action.sa_flags = SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    for (std::size_t i = 0; i < fatal_signals.size(); ++i)
+    {
+        ::sigaction(fatal_signals[i], &action, &previous_actions[i]);
+    }
+#endif
+}
+
+} // namespace
+
+std::byte * begin_flight_record(
+    const LogLevel level,
+    const std::source_location & location,
+    const u32 suppressed,
+    const fmt::string_view format,
+    const FormatFn formatter,
+    const std::size_t args_size)
+{
+    auto & ring = thread_ring.get();
+    const auto position = ring.written.load(std::memory_order_relaxed);
+    auto & slot = ring.slots[position & ring.mask];
+    slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto & entry = slot.entry;
+    const bool fits = args_size <= entry.args.size();
+    entry.ticks = read_ticks();
+    entry.location = location;
+    entry.format = format.data();
+    entry.formatter = fits ? formatter : nullptr;
+    entry.format_size = static_cast<u32>(format.size());
+    entry.thread_id = current_thread_id();
+    entry.suppressed = suppressed;
+    entry.level = level;
+    return fits ? entry.args.data() : nullptr;
+}
+
+void commit_flight_record() noexcept
+{
+    auto & ring = thread_ring.current();
+    const auto position = ring.written.load(std::memory_order_relaxed);
+    ring.slots[position & ring.mask].sequence.store(2 * position + 2, std::memory_order_release);
+    ring.written.store(position + 1, std::memory_order_release);
+}
+
+void dump_flight_recorder_on_crash() noexcept
+{
+    if (!crash_dumped.test_and_set(std::memory_order_relaxed))
+    {
+        dump_flight_recorder();
+    }
+}
+
+} // namespace __log_detail
+
+void enable_flight_recorder(const FlightRecorderOptions & options)
+{
+    using namespace __log_detail;
+    const std::lock_guard lock(flight_options_mutex);
+    if (flight_dump_state.load(std::memory_order_relaxed) == nullptr)
+    {
+        flight_dump_state.store(new FlightDumpState, std::memory_order_release);
+    }
+    flight_ring_capacity.store(
+        std::bit_ceil(std::max<std::size_t>(options.records_per_thread, 1)),
+        std::memory_order_relaxed);
+    flight_fd.store(options.fd, std::memory_order_relaxed);
+    if (options.install_signal_handlers && !signal_handlers_installed)
+    {
+        install_signal_handlers();
+        signal_handlers_installed = true;
+    }
+    flight_recorder_level.store(std::min(options.level, LogLevel::fatal), std::memory_order_relaxed);
+    update_submit_log_level();
+}
+
+void dump_flight_recorder() noexcept
+{
+    using namespace __log_detail;
+    auto * const state = flight_dump_state.load(std::memory_order_acquire);
+    if (state == nullptr || flight_dumping.test_and_set(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    const auto fd = flight_fd.load(std::memory_order_relaxed);
+    auto * const rings = flight_rings.load(std::memory_order_acquire);
+    for (auto * ring = rings; ring != nullptr; ring = ring->next)
+    {
+        ring->dump_end = ring->written.load(std::memory_order_acquire);
+        ring->dump_position = ring->dump_end - std::min(ring->dump_end, ring->mask + 1);
+        ring->dump_loaded = load_next(*ring);
+    }
+    state->ticks.update();
+
+    auto & buffer = state->buffer;
+    buffer.clear();
+    buffer.append(std::string_view("--- flight recorder ---\n"));
+    while (true)
+    {
+        // Rings are merged by the time of their oldest record not yet written.
+        FlightRing * oldest = nullptr;
+        for (auto * ring = rings; ring != nullptr; ring = ring->next)
+        {
+            if (ring->dump_loaded && (oldest == nullptr || ring->dump_entry.ticks < oldest->dump_entry.ticks))
+            {
+                oldest = ring;
+            }
+        }
+        if (oldest == nullptr)
+        {
+            break;
+        }
+
+        try
+        {
+            format_entry(*state, oldest->dump_entry);
+        }
+        catch (...)
+        {
+            buffer.append(std::string_view(" [formatting failed]\n"));
+        }
+        if (buffer.size() >= FlightDumpState::write_threshold)
+        {
+            write_buffer(fd, buffer);
+        }
+        oldest->dump_loaded = load_next(*oldest);
+    }
+    buffer.append(std::string_view("--- end of flight recorder ---\n"));
+    write_buffer(fd, buffer);
+
+    flight_dumping.clear(std::memory_order_release);
+}
+
+} // namespace ka
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace ka::__log_detail
+{
+
+//! Keeps submit_log_level the lower of runtime_log_level and flight_recorder_level, called after either changes.
+void update_submit_log_level();
+
+//! Dumps the flight recorder the first time a crash is reported, so that an assertion failure followed by the
+//! SIGABRT of std::abort writes the records once.
+void dump_flight_recorder_on_crash() noexcept;
+
+} // namespace ka::__log_detail
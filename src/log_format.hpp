@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+#include <source_location>
+#include <string_view>
+
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable : 4996)
+    #include <fmt/format.h>
+    #pragma warning(pop)
+#else
+    #include <fmt/format.h>
+#endif
+
+#include <ka/common/charconv.hpp>
+#include <ka/common/fixed.hpp>
+#include <ka/common/log.hpp>
+
+namespace ka::__log_detail
+{
+
+[[nodiscard]] constexpr std::string_view level_name(const LogLevel level) noexcept
+{
+    switch (level)
+    {
+    case LogLevel::debug:
+        return "D";
+    case LogLevel::info:
+        return "I";
+    case LogLevel::warning:
+        return "W";
+    case LogLevel::error:
+        return "E";
+    case LogLevel::fatal:
+        return "F";
+    }
+    return "?";
+}
+
+[[nodiscard]] constexpr bool is_path_separator(const char c) noexcept
+{
+    return c == '/' || c == '\\';
+}
+
+[[nodiscard]] constexpr std::string_view parent_path(std::string_view path, int levels) noexcept
+{
+    for (; levels > 0; --levels)
+    {
+        const auto separator = path.find_last_of("/\\");
+        if (separator == std::string_view::npos)
+        {
+            return {};
+        }
+        path = path.substr(0, separator);
+    }
+    return path;
+}
+
+#ifdef KA_LOG_SOURCE_ROOT
+constexpr std::string_view source_root = KA_LOG_SOURCE_ROOT;
+#else
+// The directory containing this repository.
+constexpr std::string_view source_root = parent_path(std::source_location::current().file_name(), 3);
+#endif
+
+//! Makes paths inside source_root relative to it, other paths are left unchanged.
+[[nodiscard]] constexpr std::string_view trim_source_path(std::string_view path) noexcept
+{
+    if (!source_root.empty() && path.size() > source_root.size() && path.starts_with(source_root) &&
+        is_path_separator(path[source_root.size()]))
+    {
+        path.remove_prefix(source_root.size() + 1);
+    }
+    return path;
+}
+
+static_assert(trim_source_path(std::source_location::current().file_name()).ends_with("log_format.hpp"));
+
+//! Formats nanoseconds since the Unix epoch as an ISO 8601 UTC time with microseconds.
+//! The date and time of day are formatted once per second, records of the same second reuse them.
+class TimestampFormatter final
+{
+public:
+    void format(fmt::memory_buffer & out, const u64 nanoseconds)
+    {
+        constexpr u64 nanoseconds_per_second = 1'000'000'000;
+        const auto seconds = nanoseconds / nanoseconds_per_second;
+        if (seconds != cached_seconds_ || cached_.size() == 0)
+        {
+            cache(seconds);
+        }
+        out.append(cached_.data(), cached_.data() + cached_.size());
+        std::array<char, 8> microseconds;
+        microseconds.front() = '.';
+        write_digits(microseconds.data() + 1, nanoseconds % nanoseconds_per_second / 1000, 6);
+        microseconds.back() = 'Z';
+        out.append(microseconds.data(), microseconds.data() + microseconds.size());
+    }
+
+private:
+    void cache(const u64 seconds)
+    {
+        constexpr u64 seconds_per_day = 24 * 60 * 60;
+        // Converts days since the Unix epoch to a civil date, see http://howardhinnant.github.io/date_algorithms.html
+        const auto days = static_cast<s64>(seconds / seconds_per_day) + 719468;
+        const auto era = days / 146097;
+        const auto day_of_era = days - era * 146097;
+        const auto year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+        const auto day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        const auto shifted_month = (5 * day_of_year + 2) / 153;
+        const auto day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+        const auto month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+        const auto year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+        const auto time = seconds % seconds_per_day;
+        cached_.clear();
+        fmt::format_to(
+            fmt::appender(cached_),
+            "{:04}-{:02}-{:02}T{:02}:{:02}:{:02}",
+            year,
+            month,
+            day,
+            time / 3600,
+            time / 60 % 60,
+            time % 60);
+        cached_seconds_ = seconds;
+    }
+
+private:
+    fmt::basic_memory_buffer<char, 32> cached_;
+    u64 cached_seconds_ = 0;
+};
+
+//! Text records are `<level> <time> <thread> (<file>:<line>.<column>) <message>[ (<suppressed> suppressed)]`, one
+//! per line.
+inline void format_prefix(
+    fmt::memory_buffer & out,
+    TimestampFormatter & timestamps,
+    const LogLevel level,
+    const u64 nanoseconds,
+    const u32 thread_id,
+    const std::string_view file,
+    const u32 line,
+    const u32 column)
+{
+    out.append(level_name(level));
+    out.push_back(' ');
+    timestamps.format(out, nanoseconds);
+    // Numbers are written directly, they are most of the prefix and a format string would parse it per record.
+    out.push_back(' ');
+    append_number(out, thread_id);
+    out.append(std::string_view(" ("));
+    out.append(file);
+    out.push_back(':');
+    append_number(out, line);
+    out.push_back('.');
+    append_number(out, column);
+    out.append(std::string_view(") "));
+}
+
+inline void format_suffix(fmt::memory_buffer & out, const u32 suppressed)
+{
+    if (suppressed != 0)
+    {
+        out.append(std::string_view(" ("));
+        append_number(out, suppressed);
+        out.append(std::string_view(" suppressed)"));
+    }
+    out.push_back('\n');
+}
+
+} // namespace ka::__log_detail
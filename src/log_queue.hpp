@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include <ka/common/fixed.hpp>
+
+namespace ka::__log_detail
+{
+
+//! Bounded multi-producer single-consumer queue.
+//! Every cell carries a sequence number which tells producers and the consumer whose turn it is, so neither side
+//! takes a lock. The consumer side must be serialized by the caller.
+template <typename T>
+class BoundedQueue final
+{
+public:
+    explicit BoundedQueue(const std::size_t capacity)
+        : cells_(std::make_unique<Cell[]>(std::bit_ceil(capacity)))
+        , mask_(std::bit_ceil(capacity) - 1)
+    {
+        for (std::size_t i = 0; i <= mask_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    //! Returns the position of a reserved cell or nothing if the queue is full.
+    //! The cell is accessible through operator[] and must be published afterwards.
+    [[nodiscard]] std::optional<std::size_t> try_reserve() noexcept
+    {
+        auto position = enqueue_position_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            const auto sequence = cells_[position & mask_].sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+            if (difference == 0)
+            {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    return position;
+                }
+            }
+            else if (difference < 0)
+            {
+                return std::nullopt;
+            }
+            else
+            {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]] T & operator[](const std::size_t position) noexcept
+    {
+        return cells_[position & mask_].value;
+    }
+
+    //! Makes a reserved cell visible to the consumer.
+    void publish(const std::size_t position) noexcept
+    {
+        cells_[position & mask_].sequence.store(position + 1, std::memory_order_release);
+    }
+
+    //! Calls consume(T &) on the oldest published cell and releases it. Returns false if there is none.
+    template <typename F>
+    [[nodiscard]] bool try_pop(F && consume) noexcept
+    {
+        const auto position = dequeue_position_.load(std::memory_order_relaxed);
+        Cell & cell = cells_[position & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+        {
+            return false;
+        }
+        consume(cell.value);
+        cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+        dequeue_position_.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        const auto position = dequeue_position_.load(std::memory_order_relaxed);
+        return cells_[position & mask_].sequence.load(std::memory_order_acquire) != position + 1;
+    }
+
+private:
+    struct alignas(cache_line_size) Cell final
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+private:
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_;
+    alignas(cache_line_size) std::atomic<std::size_t> enqueue_position_ = 0;
+    alignas(cache_line_size) std::atomic<std::size_t> dequeue_position_ = 0;
+};
+
+} // namespace ka::__log_detail
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <source_location>
+#include <span>
+
+#include <ka/common/arena.hpp>
+#include <ka/common/fixed.hpp>
+#include <ka/common/log.hpp>
+
+#include "log_capture.hpp"
+#include "log_queue.hpp"
+
+namespace ka::__log_detail
+{
+
+//! Log record on its way from a producer thread to the consumer.
+//! The record keeps the format string and the stored arguments, formatting is left to the consumer.
+//! Short argument lists are stored inline, the inline storage of longer ones holds a pointer to a block of the
+//! producer's pool, which the consumer hands back when it releases the record.
+//! Everything but the arguments fits into the cache line shared with the sequence number of the queue cell.
+class LogRecord final
+{
+public:
+    constexpr static std::size_t inline_capacity = 192;
+
+public:
+    //! Returns the storage for args_size bytes of arguments.
+    //! Not being able to allocate it terminates the program, an unpublished record would stall the queue.
+    [[nodiscard]] std::byte * assign(
+        const LogLevel level,
+        const std::source_location & location,
+        const u32 suppressed,
+        const fmt::string_view format,
+        const FormatFn formatter,
+        const std::size_t args_size) noexcept
+    {
+        ticks_ = read_ticks();
+        location_ = location;
+        format_ = format.data();
+        formatter_ = formatter;
+        format_size_ = static_cast<u32>(format.size());
+        args_size_ = static_cast<u32>(args_size);
+        thread_id_ = current_thread_id();
+        suppressed_ = suppressed;
+        level_ = level;
+        if (args_size_ > inline_capacity)
+        {
+            auto * const spill = static_cast<std::byte *>(thread_pool().allocate(args_size_));
+            std::memcpy(inline_args_.data(), &spill, sizeof(spill));
+        }
+        return args_storage();
+    }
+
+    //! Frees the spilled storage of the arguments, if any.
+    void release() noexcept
+    {
+        if (args_size_ > inline_capacity)
+        {
+            PoolResource::deallocate(args_storage());
+            args_size_ = 0;
+        }
+    }
+
+    //! Convert with TickConverter.
+    [[nodiscard]] u64 ticks() const noexcept
+    {
+        return ticks_;
+    }
+
+    [[nodiscard]] u32 thread_id() const noexcept
+    {
+        return thread_id_;
+    }
+
+    [[nodiscard]] LogLevel level() const noexcept
+    {
+        return level_;
+    }
+
+    [[nodiscard]] const std::source_location & location() const noexcept
+    {
+        return location_;
+    }
+
+    [[nodiscard]] u32 suppressed() const noexcept
+    {
+        return suppressed_;
+    }
+
+    [[nodiscard]] fmt::string_view format() const noexcept
+    {
+        return { format_, format_size_ };
+    }
+
+    //! Arguments in the layout written by encode_args.
+    [[nodiscard]] std::span<const std::byte> args() const noexcept
+    {
+        return { const_cast<LogRecord *>(this)->args_storage(), args_size_ };
+    }
+
+    fmt::appender format_message(const fmt::appender out) const
+    {
+        return formatter_(out, format(), args().data());
+    }
+
+private:
+    [[nodiscard]] std::byte * args_storage() noexcept
+    {
+        if (args_size_ <= inline_capacity)
+        {
+            return inline_args_.data();
+        }
+        std::byte * spill;
+        std::memcpy(&spill, inline_args_.data(), sizeof(spill));
+        return spill;
+    }
+
+private:
+    u64 ticks_ = 0;
+    std::source_location location_;
+    const char * format_ = nullptr;
+    FormatFn formatter_ = nullptr;
+    u32 format_size_ = 0;
+    u32 args_size_ = 0;
+    u32 thread_id_ = 0;
+    u32 suppressed_ = 0;
+    LogLevel level_ {};
+    std::array<std::byte, inline_capacity> inline_args_;
+};
+
+// std::source_location is a single pointer with GCC and Clang.
+static_assert(
+    sizeof(std::source_location) > sizeof(void *) ||
+    sizeof(LogRecord) - LogRecord::inline_capacity + sizeof(std::size_t) <= cache_line_size);
+
+} // namespace ka::__log_detail
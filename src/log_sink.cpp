@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+#include <ka/common/log_sink.hpp>
+
+#include "log_backend.hpp"
+
+namespace ka
+{
+
+namespace
+{
+
+[[nodiscard]] std::size_t total_size(const std::span<const std::string_view> buffers) noexcept
+{
+    std::size_t result = 0;
+    for (const auto buffer : buffers)
+    {
+        result += buffer.size();
+    }
+    return result;
+}
+
+//! Write errors are ignored, there is nowhere to report them.
+void write_all(const int fd, std::span<const std::string_view> buffers)
+{
+#ifdef _WIN32
+    for (auto buffer : buffers)
+    {
+        while (!buffer.empty())
+        {
+            const auto size = static_cast<unsigned>(std::min<std::size_t>(buffer.size(), 1 << 30));
+            const auto written = ::_write(fd, buffer.data(), size);
+            if (written < 0)
+            {
+                return;
+            }
+            buffer.remove_prefix(static_cast<std::size_t>(written));
+        }
+    }
+#else
+    constexpr std::size_t max_chunk = 64;
+    std::array<iovec, max_chunk> chunk;
+    while (!buffers.empty())
+    {
+        // Adjacent buffers, such as records formatted into one batch, are merged into one iovec.
+        std::size_t count = 0;
+        while (!buffers.empty() && count < max_chunk)
+        {
+            const auto buffer = buffers.front();
+            buffers = buffers.subspan(1);
+            auto * const previous = count != 0 ? &chunk[count - 1] : nullptr;
+            if (previous != nullptr && static_cast<char *>(previous->iov_base) + previous->iov_len == buffer.data())
+            {
+                previous->iov_len += buffer.size();
+            }
+            else
+            {
+                chunk[count].iov_base = const_cast<char *>(buffer.data());
+                chunk[count].iov_len = buffer.size();
+                ++count;
+            }
+        }
+
+        auto * first = chunk.data();
+        auto * const last = chunk.data() + count;
+        while (first != last)
+        {
+            const auto written = ::writev(fd, first, static_cast<int>(last - first));
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return;
+            }
+            // Skip what was written, the last buffer may have been written partially.
+            auto remaining = static_cast<std::size_t>(written);
+            while (first != last && remaining >= first->iov_len)
+            {
+                remaining -= first->iov_len;
+                ++first;
+            }
+            if (first != last)
+            {
+                first->iov_base = static_cast<char *>(first->iov_base) + remaining;
+                first->iov_len -= remaining;
+            }
+        }
+    }
+#endif
+}
+
+[[nodiscard]] int open_for_append(const std::filesystem::path & path)
+{
+#ifdef _WIN32
+    const int fd = ::_wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to open log file " + path.string());
+    }
+    return fd;
+}
+
+void close_fd(const int fd) noexcept
+{
+#ifdef _WIN32
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+[[nodiscard]] std::filesystem::path rotated_path(const std::filesystem::path & path, const std::size_t index)
+{
+    // Appending the parts separately avoids a false -Wrestrict positive of GCC 12 on string concatenation at -O3.
+    auto result = path;
+    result += ".";
+    result += std::to_string(index);
+    return result;
+}
+
+} // namespace
+
+FdLogSink::FdLogSink(const int fd, const std::size_t buffer_size)
+    : fd_(fd)
+{
+    buffer_.reserve(buffer_size);
+}
+
+FdLogSink::~FdLogSink()
+{
+    FdLogSink::flush();
+}
+
+void FdLogSink::write(const std::span<const std::string_view> buffers)
+{
+    const auto size = total_size(buffers);
+    if (buffer_.size() + size <= buffer_.capacity())
+    {
+        for (const auto buffer : buffers)
+        {
+            buffer_.insert(buffer_.end(), buffer.begin(), buffer.end());
+        }
+        return;
+    }
+
+    if (buffer_.empty())
+    {
+        write_all(fd_, buffers);
+        return;
+    }
+
+    constexpr std::size_t max_chunk = 16;
+    std::array<std::string_view, max_chunk> chunk;
+    chunk[0] = std::string_view(buffer_.data(), buffer_.size());
+    auto rest = buffers;
+    auto count = std::min(rest.size(), max_chunk - 1);
+    std::copy_n(rest.begin(), count, chunk.begin() + 1);
+    write_all(fd_, std::span(chunk).first(count + 1));
+    buffer_.clear();
+    if (count < rest.size())
+    {
+        write_all(fd_, rest.subspan(count));
+    }
+}
+
+void FdLogSink::flush()
+{
+    if (!buffer_.empty())
+    {
+        const std::string_view buffer(buffer_.data(), buffer_.size());
+        write_all(fd_, std::span(&buffer, 1));
+        buffer_.clear();
+    }
+}
+
+FileLogSink::FileLogSink(const std::filesystem::path & path, const std::size_t buffer_size)
+    : FdLogSink(open_for_append(path), buffer_size)
+{
+}
+
+FileLogSink::~FileLogSink()
+{
+    flush();
+    close_fd(fd_);
+}
+
+RotatingFileLogSink::RotatingFileLogSink(Options options)
+    : options_(std::move(options))
+    , file_(std::make_unique<FileLogSink>(options_.path, options_.buffer_size))
+    , opened_at_(std::chrono::steady_clock::now())
+{
+    std::error_code error;
+    const auto size = std::filesystem::file_size(options_.path, error);
+    file_size_ = error ? 0 : static_cast<std::size_t>(size);
+}
+
+void RotatingFileLogSink::write(std::span<const std::string_view> buffers)
+{
+    if (options_.max_age.count() != 0 && std::chrono::steady_clock::now() - opened_at_ >= options_.max_age)
+    {
+        rotate();
+    }
+    while (!buffers.empty())
+    {
+        // Take the buffers which fit into the current file, but at least one.
+        std::size_t count = 0;
+        std::size_t size = 0;
+        while (count < buffers.size() &&
+               (options_.max_size == 0 || file_size_ + size + buffers[count].size() <= options_.max_size))
+        {
+            size += buffers[count].size();
+            ++count;
+        }
+        if (count == 0)
+        {
+            if (file_size_ != 0)
+            {
+                rotate();
+                continue;
+            }
+            size = buffers.front().size();
+            count = 1;
+        }
+        file_->write(buffers.first(count));
+        file_size_ += size;
+        buffers = buffers.subspan(count);
+    }
+}
+
+void RotatingFileLogSink::flush()
+{
+    file_->flush();
+}
+
+void RotatingFileLogSink::rotate()
+{
+    file_.reset();
+
+    std::error_code error;
+    if (options_.max_files == 0)
+    {
+        std::filesystem::remove(options_.path, error);
+    }
+    else
+    {
+        std::filesystem::remove(rotated_path(options_.path, options_.max_files), error);
+        for (auto index = options_.max_files; index > 1; --index)
+        {
+            std::filesystem::rename(rotated_path(options_.path, index - 1), rotated_path(options_.path, index), error);
+        }
+        std::filesystem::rename(options_.path, rotated_path(options_.path, 1), error);
+    }
+
+    file_ = std::make_unique<FileLogSink>(options_.path, options_.buffer_size);
+    file_size_ = 0;
+    opened_at_ = std::chrono::steady_clock::now();
+}
+
+BinaryLogSink::BinaryLogSink(std::shared_ptr<LogSink> sink) noexcept
+    : sink_(std::move(sink))
+{
+}
+
+void BinaryLogSink::write(const std::span<const std::string_view> buffers)
+{
+    sink_->write(buffers);
+}
+
+void BinaryLogSink::flush()
+{
+    sink_->flush();
+}
+
+LogEncoding BinaryLogSink::encoding() const noexcept
+{
+    return LogEncoding::binary;
+}
+
+#ifndef _WIN32
+
+MappedRingLogSink::MappedRingLogSink(const std::filesystem::path & path, const std::size_t capacity)
+    : mapping_size_(sizeof(MappedRingHeader) + capacity)
+{
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to open log ring " + path.string());
+    }
+    struct stat status;
+    const bool resume = ::fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) == mapping_size_;
+    if (!resume && ::ftruncate(fd, static_cast<off_t>(mapping_size_)) != 0)
+    {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Failed to resize log ring " + path.string());
+    }
+    void * const mapping = ::mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::system_error(error, std::generic_category(), "Failed to map log ring " + path.string());
+    }
+
+    mapping_ = static_cast<std::byte *>(mapping);
+    header_ = reinterpret_cast<MappedRingHeader *>(mapping_);
+    data_ = mapping_ + sizeof(MappedRingHeader);
+    if (!resume || std::memcmp(header_->magic, magic, sizeof(magic)) != 0 || header_->capacity != capacity)
+    {
+        std::memcpy(header_->magic, magic, sizeof(magic));
+        header_->capacity = capacity;
+        header_->position = 0;
+    }
+}
+
+MappedRingLogSink::~MappedRingLogSink()
+{
+    ::munmap(mapping_, mapping_size_);
+}
+
+void MappedRingLogSink::write(const std::span<const std::string_view> buffers)
+{
+    const auto capacity = header_->capacity;
+    auto position = header_->position;
+    for (auto buffer : buffers)
+    {
+        if (buffer.size() > capacity)
+        {
+            position += buffer.size() - capacity;
+            buffer.remove_prefix(buffer.size() - capacity);
+        }
+        const auto offset = static_cast<std::size_t>(position % capacity);
+        const auto head = std::min(buffer.size(), capacity - offset);
+        std::memcpy(data_ + offset, buffer.data(), head);
+        std::memcpy(data_, buffer.data() + head, buffer.size() - head);
+        position += buffer.size();
+    }
+    header_->position = position;
+}
+
+#endif
+
+void set_log_sinks(std::vector<std::shared_ptr<LogSink>> sinks)
+{
+    __log_detail::LogBackend::instance().set_sinks(std::move(sinks));
+}
+
+void add_log_sink(std::shared_ptr<LogSink> sink)
+{
+    __log_detail::LogBackend::instance().add_sink(std::move(sink));
+}
+
+} // namespace ka
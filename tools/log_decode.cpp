@@ -0,0 +1,315 @@
+//! Turns a binary log stream written through BinaryLogSink back into text records.
+//! Usage: ka_log_decode [file], standard input is read when no file is given.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable : 4996)
+    #include <fmt/args.h>
+    #include <fmt/format.h>
+    #pragma warning(pop)
+#else
+    #include <fmt/args.h>
+    #include <fmt/format.h>
+#endif
+
+#include <ka/common/fixed.hpp>
+#include <ka/common/log.hpp>
+
+#include "log_binary.hpp"
+#include "log_format.hpp"
+
+namespace
+{
+
+using namespace ka;
+using namespace ka::__log_detail;
+
+struct Site final
+{
+    LogLevel level;
+    u32 line;
+    u32 column;
+    std::string_view file;
+    std::string_view format;
+};
+
+//! Reads values from the input, reading past the end sets the failed flag.
+class Reader final
+{
+public:
+    explicit Reader(const std::string_view data) noexcept
+        : data_(data)
+    {
+    }
+
+    [[nodiscard]] bool at_end() const noexcept
+    {
+        return data_.empty();
+    }
+
+    [[nodiscard]] bool failed() const noexcept
+    {
+        return failed_;
+    }
+
+    template <typename T>
+    [[nodiscard]] T read() noexcept
+    {
+        T value {};
+        const auto bytes = read_bytes(sizeof(T));
+        if (!bytes.empty())
+        {
+            std::memcpy(&value, bytes.data(), sizeof(T));
+        }
+        return value;
+    }
+
+    [[nodiscard]] std::string_view read_bytes(const std::size_t size) noexcept
+    {
+        if (failed_ || size > data_.size())
+        {
+            failed_ = true;
+            return {};
+        }
+        const auto result = data_.substr(0, size);
+        data_.remove_prefix(size);
+        return result;
+    }
+
+    [[nodiscard]] u64 read_varint() noexcept
+    {
+        u64 result = 0;
+        for (int shift = 0; shift < 64 && !failed_; shift += 7)
+        {
+            const auto byte = read<u8>();
+            result |= static_cast<u64>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return result;
+            }
+        }
+        failed_ = true;
+        return 0;
+    }
+
+    [[nodiscard]] std::string_view read_string() noexcept
+    {
+        return read_bytes(read_varint());
+    }
+
+private:
+    std::string_view data_;
+    bool failed_ = false;
+};
+
+[[nodiscard]] bool push_args(Reader & reader, fmt::dynamic_format_arg_store<fmt::format_context> & store)
+{
+    const auto count = reader.read<u8>();
+    const auto types = reader.read_bytes(count);
+    for (const auto type : types)
+    {
+        switch (static_cast<ArgType>(type))
+        {
+        case ArgType::boolean:
+            store.push_back(reader.read<bool>());
+            break;
+        case ArgType::character:
+            store.push_back(reader.read<char>());
+            break;
+        case ArgType::signed_integer:
+            store.push_back(binary_log::unzigzag(reader.read_varint()));
+            break;
+        case ArgType::unsigned_integer:
+            store.push_back(reader.read_varint());
+            break;
+        case ArgType::float32:
+            store.push_back(reader.read<f32>());
+            break;
+        case ArgType::float64:
+            store.push_back(reader.read<f64>());
+            break;
+        case ArgType::pointer:
+            store.push_back(reinterpret_cast<const void *>(static_cast<std::uintptr_t>(reader.read_varint())));
+            break;
+        case ArgType::string:
+            store.push_back(fmt::string_view(reader.read_string()));
+            break;
+        default:
+            return false;
+        }
+    }
+    return !reader.failed();
+}
+
+class Decoder final
+{
+public:
+    explicit Decoder(const std::string_view input) noexcept
+        : reader_(input)
+    {
+    }
+
+    //! Decodes entries until the end of the input or the first error.
+    [[nodiscard]] bool decode(std::FILE * const output)
+    {
+        bool ok = true;
+        while (ok && !reader_.at_end())
+        {
+            ok = decode_entry();
+            if (ok && reader_.failed())
+            {
+                fmt::print(stderr, "Stream is truncated\n");
+                ok = false;
+            }
+            if (!ok || out_.size() >= 64 * 1024)
+            {
+                std::fwrite(out_.data(), 1, out_.size(), output);
+                out_.clear();
+            }
+        }
+        std::fwrite(out_.data(), 1, out_.size(), output);
+        return ok;
+    }
+
+private:
+    [[nodiscard]] bool decode_entry()
+    {
+        switch (reader_.read<binary_log::Entry>())
+        {
+        case binary_log::Entry::stream_start:
+            return decode_stream_start();
+        case binary_log::Entry::site:
+            return decode_site();
+        case binary_log::Entry::record:
+            return decode_record();
+        }
+        fmt::print(stderr, "Unknown entry type\n");
+        return false;
+    }
+
+    [[nodiscard]] bool decode_stream_start()
+    {
+        const auto magic = reader_.read_bytes(binary_log::magic.size());
+        const auto version = reader_.read<u32>();
+        if (reader_.failed())
+        {
+            return true;
+        }
+        if (magic != std::string_view(binary_log::magic.data(), binary_log::magic.size()) ||
+            version != binary_log::version)
+        {
+            fmt::print(stderr, "Unsupported stream\n");
+            return false;
+        }
+        sites_.clear();
+        timestamp_ = 0;
+        return true;
+    }
+
+    [[nodiscard]] bool decode_site()
+    {
+        const auto id = reader_.read_varint();
+        Site site;
+        site.level = reader_.read<LogLevel>();
+        site.line = static_cast<u32>(reader_.read_varint());
+        site.column = static_cast<u32>(reader_.read_varint());
+        site.file = reader_.read_string();
+        site.format = reader_.read_string();
+        if (reader_.failed())
+        {
+            return true;
+        }
+        if (sites_.size() <= id)
+        {
+            sites_.resize(id + 1);
+        }
+        sites_[id] = site;
+        return true;
+    }
+
+    [[nodiscard]] bool decode_record()
+    {
+        const auto id = reader_.read_varint();
+        timestamp_ += reader_.read_varint();
+        const auto thread_id = static_cast<u32>(reader_.read_varint());
+        const auto suppressed = static_cast<u32>(reader_.read_varint());
+        if (reader_.failed())
+        {
+            return true;
+        }
+        if (id >= sites_.size() || sites_[id].file.empty())
+        {
+            fmt::print(stderr, "Record refers to undefined site {}\n", id);
+            return false;
+        }
+        const auto & site = sites_[id];
+        store_.clear();
+        if (!push_args(reader_, store_))
+        {
+            if (!reader_.failed())
+            {
+                fmt::print(stderr, "Malformed record arguments\n");
+            }
+            return reader_.failed();
+        }
+
+        format_prefix(out_, timestamps_, site.level, timestamp_, thread_id, site.file, site.line, site.column);
+        try
+        {
+            fmt::vformat_to(fmt::appender(out_), site.format, store_);
+        }
+        catch (const fmt::format_error & error)
+        {
+            fmt::format_to(fmt::appender(out_), "<{}: {}>", error.what(), site.format);
+        }
+        format_suffix(out_, suppressed);
+        return true;
+    }
+
+private:
+    Reader reader_;
+    std::vector<Site> sites_;
+    u64 timestamp_ = 0;
+    TimestampFormatter timestamps_;
+    fmt::memory_buffer out_;
+    fmt::dynamic_format_arg_store<fmt::format_context> store_;
+};
+
+} // namespace
+
+int main(const int argc, char ** const argv)
+{
+    if (argc > 2)
+    {
+        fmt::print(stderr, "Usage: {} [file]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<char> input;
+    if (argc == 2)
+    {
+        std::ifstream file(argv[1], std::ios::binary);
+        if (!file)
+        {
+            fmt::print(stderr, "Failed to open {}\n", argv[1]);
+            return 1;
+        }
+        input.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    else
+    {
+        input.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+
+    Decoder decoder(std::string_view(input.data(), input.size()));
+    return decoder.decode(stdout) ? 0 : 1;
+}